@@ -52,6 +52,8 @@ DrawAreaBatcher::DrawAreaBatcher(Context *context)
     , flushDrawBuffers_(false)
     , minLineLength_(8.0f)
     , pointListLimit_(100)
+    , eraserRadius_(8.0f)
+    , erasing_(false)
 {
 }
 
@@ -67,7 +69,7 @@ bool DrawAreaBatcher::Create(const IntVector2 &size, Texture2D *tex2d, const Int
     SetEnabled(true);
     SetSize(size);
 
-    return true;
+    return canvas_->Create(size, lineBatcher_);
 }
 
 bool DrawAreaBatcher::CreateLineBatcher(Texture2D *tex2d, const IntRect &rect)
@@ -75,6 +77,9 @@ bool DrawAreaBatcher::CreateLineBatcher(Texture2D *tex2d, const IntRect &rect)
     if ( lineBatcher_ )
         return false;
 
+    // finished strokes render below the stroke in progress
+    canvas_ = CreateChild<StrokeCanvas>();
+
     lineBatcher_ = CreateChild<LineBatcher>();
     lineBatcher_->SetConstrainingParent(this);
 
@@ -91,15 +96,58 @@ bool DrawAreaBatcher::CreateLineBatcher(Texture2D *tex2d, const IntRect &rect)
 void DrawAreaBatcher::OnDragBegin(const IntVector2& position, const IntVector2& screenPosition, 
                            int buttons, int qualifiers, Cursor* cursor)
 {
-    drawPointsList_.Clear();
+    if (buttons != MOUSEB_RIGHT || !InsideParent(position))
+        return;
+
+    erasing_ = (qualifiers & QUAL_SHIFT) != 0;
+
+    if ( erasing_ )
+        EraseAt(position);
+    else
+        BeginStroke(position);
 }
 
 void DrawAreaBatcher::OnDragMove(const IntVector2& position, const IntVector2& screenPosition, 
                           const IntVector2& deltaPos, int buttons, int qualifiers, Cursor* cursor)
 {
-    if (buttons != MOUSEB_RIGHT || !InsideParent(position) || lineBatcher_ == NULL)
+    if (buttons != MOUSEB_RIGHT || !InsideParent(position))
+        return;
+
+    if ( erasing_ )
+        EraseAt(position);
+    else
+        AddStrokePoint(position);
+}
+
+void DrawAreaBatcher::OnDragEnd(const IntVector2& position, const IntVector2& screenPosition, 
+                                int dragButtons, int releaseButton, Cursor* cursor)
+{
+    if ( !erasing_ )
+        EndStroke();
+
+    erasing_ = false;
+}
+
+void DrawAreaBatcher::BeginStroke(const IntVector2 &pt)
+{
+    if (lineBatcher_ == NULL)
+        return;
+
+    drawPointsList_.Clear();
+
+    lastPos_ = GetScreenPosition() + pt;
+    drawPointsList_.Push( lastPos_ );
+
+    strokeBrush_ = StrokeBrush(lineBatcher_->GetColor(C_TOPLEFT), lineBatcher_->GetLinePixelSize());
+    recorder_.BeginStroke(strokeBrush_, pt);
+}
+
+void DrawAreaBatcher::AddStrokePoint(const IntVector2 &pt)
+{
+    if (lineBatcher_ == NULL)
         return;
 
+    IntVector2 screenPosition = GetScreenPosition() + pt;
     Vector2 vec((float)(lastPos_.x_ - screenPosition.x_), (float)(lastPos_.y_ - screenPosition.y_));
 
     // limit the minimum line length to push onto the linebatcher
@@ -109,16 +157,106 @@ void DrawAreaBatcher::OnDragMove(const IntVector2& position, const IntVector2& s
     lastPos_ = screenPosition;
 
     drawPointsList_.Push( screenPosition );
+    recorder_.AddPoint( pt );
 
     if ( drawPointsList_.Size() > 1 )
     {
         lineBatcher_->DrawPoints(drawPointsList_);
 
-        if (batchCountText_)
+        UpdateBatchCountText();
+    }
+}
+
+void DrawAreaBatcher::EndStroke()
+{
+    recorder_.EndStroke();
+
+    CommitStroke(strokeBrush_);
+    UpdateBatchCountText();
+}
+
+void DrawAreaBatcher::CommitStroke(const StrokeBrush &brush)
+{
+    // hand the stroke over to the canvas, the line batcher only ever holds the live stroke
+    if ( drawPointsList_.Size() > 1 )
+    {
+        canvas_->AddStroke(drawPointsList_, brush);
+    }
+
+    drawPointsList_.Clear();
+    lineBatcher_->ClearPointList();
+    lineBatcher_->ClearBatchList();
+}
+
+void DrawAreaBatcher::EraseAt(const IntVector2 &pt)
+{
+    if ( canvas_ == NULL )
+        return;
+
+    if ( canvas_->Erase(GetScreenPosition() + pt, eraserRadius_) )
+    {
+        UpdateBatchCountText();
+    }
+}
+
+bool DrawAreaBatcher::ReplayStrokes(Deserializer &source)
+{
+    if (lineBatcher_ == NULL || !StrokeRecorder::ReadHeader(source))
+        return false;
+
+    StrokeBrush brush;
+    PODVector<IntVector2> points;
+    StrokeBrush prevBrush(lineBatcher_->GetColor(C_TOPLEFT), lineBatcher_->GetLinePixelSize());
+    bool result = true;
+
+    // decode straight into the tessellator, no per-event ui input is simulated
+    while ( !source.IsEof() )
+    {
+        if ( !StrokeRecorder::ReadStroke(source, brush, points) )
         {
-            String str = String("batch count = ") + String(lineBatcher_->GetBatchCount());
-            batchCountText_->SetText( str );
+            result = false;
+            break;
         }
+
+        ReplayStroke(brush, points);
+    }
+
+    // the live stroke keeps the user's brush
+    lineBatcher_->SetColor(prevBrush.color_);
+    lineBatcher_->SetLinePixelSize(prevBrush.pixelSize_);
+
+    UpdateBatchCountText();
+
+    return result;
+}
+
+void DrawAreaBatcher::ReplayStroke(const StrokeBrush &brush, const PODVector<IntVector2> &points)
+{
+    IntVector2 screenPos = GetScreenPosition();
+
+    drawPointsList_.Resize(points.Size());
+
+    for ( unsigned i = 0; i < points.Size(); ++i )
+    {
+        drawPointsList_[i] = screenPos + points[i];
+    }
+
+    if ( drawPointsList_.Size() > 0 )
+    {
+        lastPos_ = drawPointsList_.Back();
+    }
+
+    // the canvas tessellates the stroke itself
+    CommitStroke(brush);
+}
+
+void DrawAreaBatcher::UpdateBatchCountText()
+{
+    if (batchCountText_)
+    {
+        int batchCount = lineBatcher_->GetBatchCount() + canvas_->GetBatchCount();
+        String str = String("strokes = ") + String(canvas_->GetNumStrokes()) + String(", batch count = ") + String(batchCount);
+        batchCountText_->SetText( str );
     }
 }
 
@@ -137,6 +275,7 @@ void DrawAreaTexure::RegisterObject(Context* context)
 
 DrawAreaTexure::DrawAreaTexure(Context *context)
     : BorderImage(context)
+    , brushRadius_(0)
 {
 }
 
@@ -144,11 +283,11 @@ DrawAreaTexure::~DrawAreaTexure()
 {
 }
 
-bool DrawAreaTexure::Create(const IntVector2 &size)
+bool DrawAreaTexure::Create(const IntVector2 &size, const IntVector2 &textureSize)
 {
     // set texture format
     drawTexture_ = new Texture2D(context_);
-    textureSize_ = IntVector2( 256, 256 );
+    textureSize_ = textureSize;
 
     textureScale_ = Vector2( (float)textureSize_.x_/ (float)size.x_, (float)textureSize_.y_/ (float)size.y_ );
     drawTexture_->SetMipsToSkip(QUALITY_LOW, 0);
@@ -157,14 +296,7 @@ bool DrawAreaTexure::Create(const IntVector2 &size)
 
     colorMap_ = new ColorMap(context_);
     colorMap_->SetSource(drawTexture_);
-    for (int y = 0; y < textureSize_.y_; ++y )
-    {
-        for (int x = 0; x < textureSize_.x_; ++x )
-        {
-            colorMap_->SetPixel(x, y, Color::WHITE);
-        }
-    }
-    colorMap_->ApplyColor();
+    ClearCanvas(Color::WHITE);
 
     SetTexture(drawTexture_);
 
@@ -178,13 +310,40 @@ void DrawAreaTexure::ClearBuffer()
 {
 }
 
+void DrawAreaTexure::ClearCanvas(const Color &color)
+{
+    if ( colorMap_ == NULL )
+        return;
+
+    for (int y = 0; y < textureSize_.y_; ++y )
+    {
+        for (int x = 0; x < textureSize_.x_; ++x )
+        {
+            colorMap_->SetPixel(x, y, color);
+        }
+    }
+    colorMap_->ApplyColor();
+}
+
+void DrawAreaTexure::SetBrush(const StrokeBrush &brush)
+{
+    brush_ = brush;
+
+    // a line batcher line is 2 * pixel size wide, the stamp covers half
+    // of that in texture pixels so a rasterized stroke keeps its live width
+    float lineWidth = 2.0f * brush.pixelSize_;
+    float scale = 0.5f * (textureScale_.x_ + textureScale_.y_);
+
+    brushRadius_ = Max((int)(lineWidth * 0.5f * scale), 0);
+}
+
 void DrawAreaTexure::OnDragBegin(const IntVector2& position, const IntVector2& screenPosition, 
                                  int buttons, int qualifiers, Cursor* cursor)
 {
     if (buttons != MOUSEB_RIGHT || !InsideParent(position) )
         return;
 
-    lastPos_ = position;
+    BeginStroke(position);
 }
 
 void DrawAreaTexure::OnDragMove(const IntVector2& position, const IntVector2& screenPosition, 
@@ -193,10 +352,29 @@ void DrawAreaTexure::OnDragMove(const IntVector2& position, const IntVector2& sc
     if (buttons != MOUSEB_RIGHT || !InsideParent(position) )
         return;
 
-    IntVector2 p0( (int)(textureScale_.x_ * (float)lastPos_.x_), (int)(textureScale_.y_ * (float)lastPos_.y_) );
-    IntVector2 p1( (int)(textureScale_.x_ * (float)position.x_), (int)(textureScale_.y_ * (float)position.y_) );
+    AddStrokePoint(position);
+}
+
+void DrawAreaTexure::OnDragEnd(const IntVector2& position, const IntVector2& screenPosition, 
+                               int dragButtons, int releaseButton, Cursor* cursor)
+{
+    EndStroke();
+}
+
+void DrawAreaTexure::BeginStroke(const IntVector2 &pt)
+{
+    lastPos_ = pt;
+
+    recorder_.BeginStroke(brush_, pt);
+}
+
+void DrawAreaTexure::AddStrokePoint(const IntVector2 &pt)
+{
+    IntVector2 p0 = ToTexturePoint(lastPos_);
+    IntVector2 p1 = ToTexturePoint(pt);
 
-    lastPos_ = position;
+    lastPos_ = pt;
+    recorder_.AddPoint(pt);
 
     Bresenham(p0.x_, p0.y_, p1.x_, p1.y_);
 
@@ -204,6 +382,65 @@ void DrawAreaTexure::OnDragMove(const IntVector2& position, const IntVector2& sc
     colorMap_->ApplyColor();
 }
 
+void DrawAreaTexure::EndStroke()
+{
+    recorder_.EndStroke();
+}
+
+IntVector2 DrawAreaTexure::ToTexturePoint(const IntVector2 &pt) const
+{
+    return IntVector2( (int)(textureScale_.x_ * (float)pt.x_), (int)(textureScale_.y_ * (float)pt.y_) );
+}
+
+bool DrawAreaTexure::ReplayStrokes(Deserializer &source)
+{
+    if ( colorMap_ == NULL || !StrokeRecorder::ReadHeader(source) )
+        return false;
+
+    StrokeBrush brush;
+    PODVector<IntVector2> points;
+    // the live brush, restored as is: brushRadius_ isn't always derived from brush_
+    StrokeBrush prevBrush = brush_;
+    int prevBrushRadius = brushRadius_;
+    bool result = true;
+
+    // raster everything first, then a single texture upload
+    while ( !source.IsEof() )
+    {
+        if ( !StrokeRecorder::ReadStroke(source, brush, points) )
+        {
+            result = false;
+            break;
+        }
+
+        ReplayStroke(brush, points);
+    }
+
+    brush_ = prevBrush;
+    brushRadius_ = prevBrushRadius;
+    colorMap_->ApplyColor();
+
+    return result;
+}
+
+void DrawAreaTexure::ReplayStroke(const StrokeBrush &brush, const PODVector<IntVector2> &points)
+{
+    SetBrush(brush);
+
+    for ( unsigned i = 1; i < points.Size(); ++i )
+    {
+        IntVector2 p0 = ToTexturePoint(points[i - 1]);
+        IntVector2 p1 = ToTexturePoint(points[i]);
+
+        Bresenham(p0.x_, p0.y_, p1.x_, p1.y_);
+    }
+
+    if ( points.Size() > 0 )
+    {
+        lastPos_ = points.Back();
+    }
+}
+
 // from:
 // http://www.roguebasin.com/index.php?title=Bresenham%27s_Line_Algorithm
 void DrawAreaTexure::Bresenham(int x1, int y1, int const x2, int const y2)
@@ -219,7 +456,7 @@ void DrawAreaTexure::Bresenham(int x1, int y1, int const x2, int const y2)
     delta_y = std::abs(delta_y) << 1;
  
     //plot(x1, y1);
-    colorMap_->SetPixel(x1, y1, Color::RED);
+    Plot(x1, y1);
  
     if (delta_x >= delta_y)
     {
@@ -239,7 +476,7 @@ void DrawAreaTexure::Bresenham(int x1, int y1, int const x2, int const y2)
             x1 += ix;
  
             //plot(x1, y1);
-            colorMap_->SetPixel(x1, y1, Color::RED);
+            Plot(x1, y1);
         }
     }
     else
@@ -260,7 +497,30 @@ void DrawAreaTexure::Bresenham(int x1, int y1, int const x2, int const y2)
             y1 += iy;
  
             //plot(x1, y1);
-            colorMap_->SetPixel(x1, y1, Color::RED);
+            Plot(x1, y1);
+        }
+    }
+}
+
+void DrawAreaTexure::Plot(int x, int y)
+{
+    if ( brushRadius_ == 0 )
+    {
+        colorMap_->SetPixel(x, y, brush_.color_);
+        return;
+    }
+
+    // round stamp, out of range pixels are rejected by the image
+    int rr = brushRadius_ * brushRadius_ + brushRadius_;
+
+    for ( int dy = -brushRadius_; dy <= brushRadius_; ++dy )
+    {
+        for ( int dx = -brushRadius_; dx <= brushRadius_; ++dx )
+        {
+            if ( dx * dx + dy * dy <= rr )
+            {
+                colorMap_->SetPixel(x + dx, y + dy, brush_.color_);
+            }
         }
     }
 }
@@ -271,17 +531,130 @@ bool DrawAreaTexure::InsideParent(const IntVector2 &p)
     return (p.x_ >= 0 && p.x_ <= size.x_ && p.y_ >= 0 && p.y_ <= size.y_);
 }
 
+//=============================================================================
+//=============================================================================
+void DrawAreaHybrid::RegisterObject(Context* context)
+{
+    context->RegisterFactory<DrawAreaHybrid>();
+}
+
+DrawAreaHybrid::DrawAreaHybrid(Context *context)
+    : DrawAreaTexure(context)
+    , minLineLength_(8.0f)
+    , numStrokes_(0)
+{
+}
+
+DrawAreaHybrid::~DrawAreaHybrid()
+{
+}
+
+bool DrawAreaHybrid::Create(const IntVector2 &size, Texture2D *tex2d, const IntRect &rect)
+{
+    if ( lineBatcher_ )
+        return false;
+
+    // 1:1 texture so the rasterized stroke matches what was drawn live
+    if ( !DrawAreaTexure::Create(size, size) )
+        return false;
+
+    lineBatcher_ = CreateChild<LineBatcher>();
+    lineBatcher_->SetConstrainingParent(this);
+
+    lineBatcher_->SetLineTexture(tex2d);
+    lineBatcher_->SetLineRect(rect);
+    lineBatcher_->SetLineType(STRAIGHT_LINE);
+    lineBatcher_->SetLinePixelSize(2.0f);
+    lineBatcher_->SetColor(Color::RED);
+    lineBatcher_->SetNumPointsPerSegment(0);
+
+    SetBrush(StrokeBrush(Color::RED, 2.0f));
+
+    return true;
+}
+
+void DrawAreaHybrid::BeginStroke(const IntVector2 &pt)
+{
+    if ( lineBatcher_ == NULL )
+        return;
+
+    lastPos_ = pt;
+
+    drawPointsList_.Clear();
+    drawPointsList_.Push( GetScreenPosition() + pt );
+    strokePoints_.Clear();
+    strokePoints_.Push( pt );
+
+    // the raster pass uses the live line's brush
+    SetBrush(StrokeBrush(lineBatcher_->GetColor(C_TOPLEFT), lineBatcher_->GetLinePixelSize()));
+    recorder_.BeginStroke(brush_, pt);
+}
+
+void DrawAreaHybrid::AddStrokePoint(const IntVector2 &pt)
+{
+    if ( lineBatcher_ == NULL || strokePoints_.Size() == 0 )
+        return;
+
+    Vector2 vec((float)(lastPos_.x_ - pt.x_), (float)(lastPos_.y_ - pt.y_));
+
+    // limit the minimum line length to push onto the linebatcher
+    if ( vec.Length() < minLineLength_ )
+        return;
+
+    lastPos_ = pt;
+
+    drawPointsList_.Push( GetScreenPosition() + pt );
+    strokePoints_.Push( pt );
+    recorder_.AddPoint( pt );
+
+    lineBatcher_->DrawPoints(drawPointsList_);
+
+    UpdateBatchCountText();
+}
+
+void DrawAreaHybrid::EndStroke()
+{
+    recorder_.EndStroke();
+
+    if ( strokePoints_.Size() > 1 )
+    {
+        // one raster pass and one upload per stroke
+        ReplayStroke(brush_, strokePoints_);
+        colorMap_->ApplyColor();
+        numStrokes_++;
+    }
+
+    strokePoints_.Clear();
+    drawPointsList_.Clear();
+    lineBatcher_->ClearPointList();
+    lineBatcher_->ClearBatchList();
+
+    UpdateBatchCountText();
+}
+
+void DrawAreaHybrid::UpdateBatchCountText()
+{
+    if (batchCountText_)
+    {
+        String str = String("strokes = ") + String(numStrokes_) + String(", batch count = ") + String(lineBatcher_->GetBatchCount() + 1);
+        batchCountText_->SetText( str );
+    }
+}
+
 //=============================================================================
 //=============================================================================
 void DrawTool::RegisterObject(Context* context)
 {
     context->RegisterFactory<DrawTool>();
+    StrokeCanvas::RegisterObject(context);
     DrawAreaBatcher::RegisterObject(context);
     DrawAreaTexure::RegisterObject(context);
+    DrawAreaHybrid::RegisterObject(context);
 }
 
 DrawTool::DrawTool(Context *context) 
     : BorderImage(context)
+    , drawAreaType_(DRAWAREA_TEXTURE)
 {
     SetLayoutMode(LM_VERTICAL);
     borderRect_ = IntRect(3,3,3,3);
@@ -311,9 +684,9 @@ bool DrawTool::InitInternal(const IntVector2 &size)
     return true;
 }
 
-bool DrawTool::Create(const IntVector2 &size, Texture2D *tex2d, const IntRect &rect, bool useLineBatcher)
+bool DrawTool::Create(const IntVector2 &size, Texture2D *tex2d, const IntRect &rect, DrawAreaType drawAreaType)
 {
-    useLineBatcher_ = useLineBatcher;
+    drawAreaType_ = drawAreaType;
 
     // min size requirement
     if ( size.x_ < 200 || size.y_ < 200 )
@@ -335,16 +708,22 @@ bool DrawTool::CreateDrawArea(const IntVector2 &size, Texture2D *tex2d, const In
     drawAreaSize.x_ = size.x_ - borderRect_.left_ - borderRect_.right_;
     drawAreaSize.y_ = size.y_ - borderRect_.top_ - borderRect_.bottom_ - MIN_BAR_HEIGHT;
 
-    if ( useLineBatcher_ )
+    switch ( drawAreaType_ )
     {
+    case DRAWAREA_LINEBATCHER:
         drawArea_ = CreateChild<DrawAreaBatcher>();
         drawArea_->SetBatchCountText(batchCountText_);
         return drawArea_->Create(drawAreaSize, tex2d, rect);
-    }
-    else
-    {
+
+    case DRAWAREA_HYBRID:
+        drawAreaHybrid_ = CreateChild<DrawAreaHybrid>();
+        drawAreaHybrid_->SetBatchCountText(batchCountText_);
+        return drawAreaHybrid_->Create(drawAreaSize, tex2d, rect);
+
+    default:
         drawAreaTexture_ = CreateChild<DrawAreaTexure>();
         drawAreaTexture_->Create(drawAreaSize);
+        break;
     }
 
     return true;
@@ -354,10 +733,15 @@ void DrawTool::SetScreenColor(const Color &color)
 {
     colorScreen_ = color;
 
-    if ( useLineBatcher_ )
+    if ( drawAreaType_ == DRAWAREA_LINEBATCHER )
     {
         drawArea_->SetColor(colorScreen_);
     }
+    else if ( drawAreaType_ == DRAWAREA_HYBRID )
+    {
+        // background is part of the raster, a tint would also darken the strokes
+        drawAreaHybrid_->ClearCanvas(colorScreen_);
+    }
 }
 
 void DrawTool::SetColor(const Color& color)
@@ -22,6 +22,8 @@
 #pragma once
 #include <Urho3D/UI/BorderImage.h>
 #include "LineBatcher.h"
+#include "StrokeRecorder.h"
+#include "StrokeCanvas.h"
 
 namespace Urho3D
 {
@@ -53,14 +55,40 @@ public:
     virtual void OnDragMove(const IntVector2& position, const IntVector2& screenPosition, 
                             const IntVector2& deltaPos, int buttons, int qualifiers, Cursor* cursor);
 
+    virtual void OnDragEnd(const IntVector2& position, const IntVector2& screenPosition, 
+                           int dragButtons, int releaseButton, Cursor* cursor);
+
     void SetBatchCountText(Text *text) { batchCountText_ = text;}
 
+    // stroke input, positions are element-local
+    void BeginStroke(const IntVector2 &pt);
+    void AddStrokePoint(const IntVector2 &pt);
+    void EndStroke();
+
+    // eraser, shift + RMB drag
+    void EraseAt(const IntVector2 &pt);
+    void SetEraserRadius(float radius) { eraserRadius_ = radius; }
+    StrokeCanvas* GetCanvas() { return canvas_; }
+    LineBatcher* GetLineBatcher() { return lineBatcher_; }
+
+    // record/replay
+    StrokeRecorder& GetStrokeRecorder() { return recorder_; }
+    bool ReplayStrokes(Deserializer &source);
+
 protected:
     bool CreateLineBatcher(Texture2D *tex2d, const IntRect &rect);
     bool InsideParent(const IntVector2 &position);
+    void CommitStroke(const StrokeBrush &brush);
+    void ReplayStroke(const StrokeBrush &brush, const PODVector<IntVector2> &points);
+    void UpdateBatchCountText();
 
 protected:
+    WeakPtr<StrokeCanvas> canvas_;
     WeakPtr<LineBatcher>  lineBatcher_;
+    StrokeRecorder        recorder_;
+    StrokeBrush           strokeBrush_;
+    float                 eraserRadius_;
+    bool                  erasing_;
 
     PODVector<IntVector2> drawPointsList_;
     int                   drawPointsIndex_;
@@ -78,7 +106,7 @@ class ColorMap : public Image
     URHO3D_OBJECT(ColorMap, Image);
 
 public:
-    ColorMap(Context *_pContext) : Image( _pContext ) {}
+    ColorMap(Context *_pContext) : Image( _pContext ), numUploads_(0), uploadBytes_(0) {}
     virtual ~ColorMap(){}
 
     void SetSource(Texture2D *texture)
@@ -90,11 +118,23 @@ public:
 
     void ApplyColor()
     {
+        numUploads_++;
+        uploadBytes_ += (unsigned long long)(GetWidth() * GetHeight() * GetComponents());
+
+        // headless, no gpu texture to update
+        if ( textureSrc_->GetGraphics() == NULL )
+            return;
+
         textureSrc_->SetData( 0, 0, 0, GetWidth(), GetHeight(), GetData() );
     }
 
+    unsigned GetNumUploads() const              { return numUploads_; }
+    unsigned long long GetUploadBytes() const   { return uploadBytes_; }
+
 protected:
     WeakPtr<Texture2D> textureSrc_;
+    unsigned           numUploads_;
+    unsigned long long uploadBytes_;
 };
 
 class DrawAreaTexure : public BorderImage
@@ -106,21 +146,44 @@ public:
     DrawAreaTexure(Context *context);
     virtual ~DrawAreaTexure();
 
-    bool Create(const IntVector2 &size);
+    bool Create(const IntVector2 &size, const IntVector2 &textureSize = IntVector2(256, 256));
     virtual void OnDragBegin(const IntVector2& position, const IntVector2& screenPosition, 
                              int buttons, int qualifiers, Cursor* cursor);
 
     virtual void OnDragMove(const IntVector2& position, const IntVector2& screenPosition, 
                             const IntVector2& deltaPos, int buttons, int qualifiers, Cursor* cursor);
 
+    virtual void OnDragEnd(const IntVector2& position, const IntVector2& screenPosition, 
+                           int dragButtons, int releaseButton, Cursor* cursor);
+
+    // stroke input, positions are element-local
+    virtual void BeginStroke(const IntVector2 &pt);
+    virtual void AddStrokePoint(const IntVector2 &pt);
+    virtual void EndStroke();
+
+    void SetBrush(const StrokeBrush &brush);
+    const StrokeBrush& GetBrush() const { return brush_; }
+    void ClearCanvas(const Color &color);
+    ColorMap* GetColorMap() { return colorMap_; }
+
+    // record/replay
+    StrokeRecorder& GetStrokeRecorder() { return recorder_; }
+    bool ReplayStrokes(Deserializer &source);
+
 protected:
     void ClearBuffer();
     void Bresenham(int x1, int y1, int x2, int y2);
+    void Plot(int x, int y);
     bool InsideParent(const IntVector2 &position);
+    IntVector2 ToTexturePoint(const IntVector2 &pt) const;
+    void ReplayStroke(const StrokeBrush &brush, const PODVector<IntVector2> &points);
 
 protected:
     SharedPtr<Texture2D> drawTexture_;
     SharedPtr<ColorMap>  colorMap_;
+    StrokeRecorder       recorder_;
+    StrokeBrush          brush_;
+    int                  brushRadius_;
 
     IntVector2           textureSize_;
     Vector2              textureScale_;
@@ -128,8 +191,50 @@ protected:
     unsigned             pointListLimit_;
 };
 
+//=============================================================================
+// the stroke in progress is drawn with the line batcher, on release it's
+// rasterized into the canvas texture and its geometry is dropped, so the
+// per-frame cost doesn't grow with the amount drawn
+//=============================================================================
+class DrawAreaHybrid : public DrawAreaTexure
+{
+    URHO3D_OBJECT(DrawAreaHybrid, DrawAreaTexure);
+public:
+    static void RegisterObject(Context* context);
+
+    DrawAreaHybrid(Context *context);
+    virtual ~DrawAreaHybrid();
+
+    bool Create(const IntVector2 &size, Texture2D *tex2d, const IntRect &rect);
+    void SetBatchCountText(Text *text) { batchCountText_ = text;}
+    LineBatcher* GetLineBatcher() { return lineBatcher_; }
+
+    virtual void BeginStroke(const IntVector2 &pt);
+    virtual void AddStrokePoint(const IntVector2 &pt);
+    virtual void EndStroke();
+
+protected:
+    void UpdateBatchCountText();
+
+protected:
+    WeakPtr<LineBatcher>  lineBatcher_;
+    PODVector<IntVector2> drawPointsList_;
+    PODVector<IntVector2> strokePoints_;
+    float                 minLineLength_;
+    unsigned              numStrokes_;
+
+    WeakPtr<Text>         batchCountText_;
+};
+
 //=============================================================================
 //=============================================================================
+enum DrawAreaType
+{
+    DRAWAREA_TEXTURE,
+    DRAWAREA_LINEBATCHER,
+    DRAWAREA_HYBRID,
+};
+
 class DrawTool : public BorderImage
 {
     URHO3D_OBJECT(DrawTool, BorderImage);
@@ -139,7 +244,7 @@ public:
     DrawTool(Context *context);
     virtual ~DrawTool();
 
-    bool Create(const IntVector2 &size, Texture2D *tex2d, const IntRect &rect, bool useLineBatcher);
+    bool Create(const IntVector2 &size, Texture2D *tex2d, const IntRect &rect, DrawAreaType drawAreaType);
     void SetColor(const Color& color);
     bool SetHeaderFont(const String& fontName, int size = DEFAULT_FONT_SIZE);
     bool SetHeaderFont(Font* font, int size = DEFAULT_FONT_SIZE);
@@ -157,9 +262,10 @@ protected:
 
     WeakPtr<DrawAreaBatcher> drawArea_;
     WeakPtr<DrawAreaTexure>  drawAreaTexture_;
+    WeakPtr<DrawAreaHybrid>  drawAreaHybrid_;
 
     IntRect                  borderRect_;
-    bool                     useLineBatcher_;
+    DrawAreaType             drawAreaType_;
     Color                    colorScreen_;
 
 };
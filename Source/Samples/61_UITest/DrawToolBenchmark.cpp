@@ -0,0 +1,288 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/UI/UIElement.h>
+
+#include "DrawTool.h"
+#include "DrawToolBenchmark.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define BENCHMARK_RANDOM_SEED   1
+#define BENCHMARK_STEP          10.0f
+
+//=============================================================================
+//=============================================================================
+DrawBenchmarkResult::DrawBenchmarkResult()
+    : numEvents_(0)
+    , eventUSec_(0)
+    , maxEventUSec_(0)
+    , frameUSec_(0)
+    , uploadBytes_(0)
+    , vertexBytes_(0)
+    , batchCount_(0)
+    , peakBatchCount_(0)
+    , peakMemory_(0)
+{
+}
+
+//=============================================================================
+//=============================================================================
+DrawToolBenchmark::DrawToolBenchmark(Context *context)
+    : Object(context)
+    , lineRect_(84, 87, 85, 88)
+{
+}
+
+DrawToolBenchmark::~DrawToolBenchmark()
+{
+}
+
+void DrawToolBenchmark::Run(const IntVector2 &areaSize)
+{
+    areaSize_ = areaSize;
+    lineTexture_ = GetSubsystem<ResourceCache>()->GetResource<Texture2D>("Textures/UI.png");
+
+    // detached from the ui root, nothing here is rendered
+    root_ = new UIElement(context_);
+    root_->SetSize(areaSize_);
+    results_.Clear();
+
+    StrokeSet strokes;
+
+    CreateSpirals(strokes);
+    RunStrokeSet("spirals", strokes);
+
+    CreateScribbles(strokes);
+    RunStrokeSet("scribbles", strokes);
+
+    CreateStraightRuns(strokes);
+    RunStrokeSet("straight runs", strokes);
+
+    root_.Reset();
+}
+
+void DrawToolBenchmark::CreateSpirals(StrokeSet &strokes) const
+{
+    strokes.Clear();
+
+    Vector2 center((float)areaSize_.x_ * 0.5f, (float)areaSize_.y_ * 0.5f);
+    float maxRadius = (float)Min(areaSize_.x_, areaSize_.y_) * 0.45f;
+
+    for ( int s = 0; s < 8; ++s )
+    {
+        PODVector<IntVector2> points;
+        float radius = 4.0f;
+        float angle = (float)s * 45.0f;
+
+        // constant arc length step
+        while ( radius < maxRadius )
+        {
+            points.Push(IntVector2((int)(center.x_ + Cos(angle) * radius), (int)(center.y_ + Sin(angle) * radius)));
+            angle += BENCHMARK_STEP / radius * M_RADTODEG;
+            radius += 0.3f;
+        }
+
+        strokes.Push(points);
+    }
+}
+
+void DrawToolBenchmark::CreateScribbles(StrokeSet &strokes) const
+{
+    strokes.Clear();
+    SetRandomSeed(BENCHMARK_RANDOM_SEED);
+
+    for ( int s = 0; s < 40; ++s )
+    {
+        PODVector<IntVector2> points;
+        Vector2 pt(Random((float)areaSize_.x_), Random((float)areaSize_.y_));
+        float angle = Random(360.0f);
+
+        for ( int i = 0; i < 60; ++i )
+        {
+            points.Push(IntVector2((int)pt.x_, (int)pt.y_));
+
+            angle += Random(-60.0f, 60.0f);
+            pt.x_ = Clamp(pt.x_ + Cos(angle) * BENCHMARK_STEP, 0.0f, (float)areaSize_.x_);
+            pt.y_ = Clamp(pt.y_ + Sin(angle) * BENCHMARK_STEP, 0.0f, (float)areaSize_.y_);
+        }
+
+        strokes.Push(points);
+    }
+}
+
+void DrawToolBenchmark::CreateStraightRuns(StrokeSet &strokes) const
+{
+    strokes.Clear();
+
+    for ( int y = 10; y < areaSize_.y_ - 10; y += 20 )
+    {
+        PODVector<IntVector2> points;
+
+        for ( int x = 5; x < areaSize_.x_ - 5; x += (int)BENCHMARK_STEP )
+        {
+            points.Push(IntVector2(x, y));
+        }
+
+        strokes.Push(points);
+    }
+}
+
+void DrawToolBenchmark::RunStrokeSet(const String &name, const StrokeSet &strokes)
+{
+    // a fresh area per run so that every backend starts empty. the texture
+    // gets the area's size, all three backends work at the same resolution
+    // with the line batcher's default brush
+    SharedPtr<DrawAreaTexure> texture(root_->CreateChild<DrawAreaTexure>());
+    texture->Create(areaSize_, areaSize_);
+    texture->SetBrush(StrokeBrush(Color::RED, 2.0f));
+    RunBackend(texture.Get(), "texture", name, strokes);
+
+    SharedPtr<DrawAreaBatcher> batcher(root_->CreateChild<DrawAreaBatcher>());
+    batcher->Create(areaSize_, lineTexture_, lineRect_);
+    RunBackend(batcher.Get(), "linebatcher", name, strokes);
+
+    SharedPtr<DrawAreaHybrid> hybrid(root_->CreateChild<DrawAreaHybrid>());
+    hybrid->Create(areaSize_, lineTexture_, lineRect_);
+    RunBackend(hybrid.Get(), "hybrid", name, strokes);
+}
+
+template <class T> void DrawToolBenchmark::RunBackend(T *area, const String &backend, const String &strokeSet, const StrokeSet &strokes)
+{
+    DrawBenchmarkResult result;
+    result.backend_ = backend;
+    result.strokeSet_ = strokeSet;
+
+    RunStrokes(area, strokes, result);
+    result.uploadBytes_ = GetUploadBytes(area);
+
+    area->Remove();
+    LogResult(result);
+    results_.Push(result);
+}
+
+template <class T> void DrawToolBenchmark::RunStrokes(T *area, const StrokeSet &strokes, DrawBenchmarkResult &result)
+{
+    HiresTimer timer;
+
+    for ( unsigned s = 0; s < strokes.Size(); ++s )
+    {
+        const PODVector<IntVector2> &points = strokes[s];
+
+        // one event per point plus the release, the same entry points the drag handlers use
+        for ( unsigned i = 0; i <= points.Size(); ++i )
+        {
+            timer.Reset();
+
+            if ( i == 0 )
+                area->BeginStroke(points[i]);
+            else if ( i < points.Size() )
+                area->AddStrokePoint(points[i]);
+            else
+                area->EndStroke();
+
+            long long usec = timer.GetUSec(false);
+            result.eventUSec_ += usec;
+            result.maxEventUSec_ = Max(result.maxEventUSec_, usec);
+            result.numEvents_++;
+
+            MeasureFrame(area, GetResidentBytes(area), result);
+        }
+    }
+}
+
+void DrawToolBenchmark::MeasureFrame(UIElement *area, unsigned residentBytes, DrawBenchmarkResult &result)
+{
+    HiresTimer timer;
+    IntRect scissor(0, 0, areaSize_.x_, areaSize_.y_);
+    PODVector<UIElement*> elements;
+
+    batches_.Clear();
+    vertexData_.Clear();
+
+    // same gather the ui does every frame for this subtree
+    area->GetChildren(elements, true);
+    area->GetBatches(batches_, vertexData_, scissor);
+
+    for ( unsigned i = 0; i < elements.Size(); ++i )
+    {
+        elements[i]->GetBatches(batches_, vertexData_, scissor);
+    }
+
+    result.frameUSec_ += timer.GetUSec(false);
+
+    unsigned vertexBytes = vertexData_.Size() * sizeof(float);
+    result.vertexBytes_ += vertexBytes;
+    result.batchCount_ = batches_.Size();
+    result.peakBatchCount_ = Max(result.peakBatchCount_, batches_.Size());
+    result.peakMemory_ = Max(result.peakMemory_, residentBytes + vertexBytes);
+}
+
+unsigned long long DrawToolBenchmark::GetUploadBytes(DrawAreaBatcher *area) const
+{
+    // vertex data goes up every frame, that's counted by MeasureFrame
+    return 0;
+}
+
+unsigned long long DrawToolBenchmark::GetUploadBytes(DrawAreaTexure *area) const
+{
+    return area->GetColorMap()->GetUploadBytes();
+}
+
+unsigned DrawToolBenchmark::GetResidentBytes(DrawAreaBatcher *area) const
+{
+    return area->GetCanvas()->GetVertexDataSize() + area->GetLineBatcher()->GetVertexData().Size() * sizeof(float);
+}
+
+unsigned DrawToolBenchmark::GetResidentBytes(DrawAreaTexure *area) const
+{
+    ColorMap *colorMap = area->GetColorMap();
+
+    // cpu side image plus the texture it's uploaded to
+    return (unsigned)(colorMap->GetWidth() * colorMap->GetHeight() * colorMap->GetComponents()) * 2;
+}
+
+unsigned DrawToolBenchmark::GetResidentBytes(DrawAreaHybrid *area) const
+{
+    return GetResidentBytes(static_cast<DrawAreaTexure*>(area)) + area->GetLineBatcher()->GetVertexData().Size() * sizeof(float);
+}
+
+void DrawToolBenchmark::LogResult(const DrawBenchmarkResult &result) const
+{
+    unsigned numEvents = Max(result.numEvents_, 1U);
+
+    URHO3D_LOGINFOF("[drawtool benchmark] %s / %s: events=%u, event avg=%.2f us, event max=%d us, frame avg=%.2f us",
+                    result.backend_.CString(), result.strokeSet_.CString(), result.numEvents_,
+                    (double)result.eventUSec_ / numEvents, (int)result.maxEventUSec_,
+                    (double)result.frameUSec_ / numEvents);
+
+    URHO3D_LOGINFOF("[drawtool benchmark] %s / %s: uploaded=%llu bytes, vertex bytes=%llu, batches=%u (peak %u), peak memory=%u bytes",
+                    result.backend_.CString(), result.strokeSet_.CString(), result.uploadBytes_,
+                    result.vertexBytes_, result.batchCount_, result.peakBatchCount_, result.peakMemory_);
+}
+
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/UI/UIBatch.h>
+
+namespace Urho3D
+{
+class UIElement;
+class Texture2D;
+}
+
+class DrawAreaBatcher;
+class DrawAreaTexure;
+class DrawAreaHybrid;
+
+using namespace Urho3D;
+//=============================================================================
+//=============================================================================
+typedef Vector<PODVector<IntVector2> > StrokeSet;
+
+struct DrawBenchmarkResult
+{
+    DrawBenchmarkResult();
+
+    String              backend_;
+    String              strokeSet_;
+    unsigned            numEvents_;
+    long long           eventUSec_;
+    long long           maxEventUSec_;
+    long long           frameUSec_;
+    unsigned long long  uploadBytes_;
+    unsigned long long  vertexBytes_;
+    unsigned            batchCount_;
+    unsigned            peakBatchCount_;
+    unsigned            peakMemory_;
+};
+
+//=============================================================================
+// replays the same synthetic stroke sets into each draw area backend and
+// logs the cost per input event and per gathered ui frame, runs headless
+//=============================================================================
+class DrawToolBenchmark : public Object
+{
+    URHO3D_OBJECT(DrawToolBenchmark, Object);
+public:
+    DrawToolBenchmark(Context *context);
+    virtual ~DrawToolBenchmark();
+
+    void Run(const IntVector2 &areaSize = IntVector2(494, 294));
+    const Vector<DrawBenchmarkResult>& GetResults() const { return results_; }
+
+protected:
+    void CreateSpirals(StrokeSet &strokes) const;
+    void CreateScribbles(StrokeSet &strokes) const;
+    void CreateStraightRuns(StrokeSet &strokes) const;
+
+    void RunStrokeSet(const String &name, const StrokeSet &strokes);
+
+    template <class T> void RunBackend(T *area, const String &backend, const String &strokeSet, const StrokeSet &strokes);
+    template <class T> void RunStrokes(T *area, const StrokeSet &strokes, DrawBenchmarkResult &result);
+    void MeasureFrame(UIElement *area, unsigned residentBytes, DrawBenchmarkResult &result);
+    void LogResult(const DrawBenchmarkResult &result) const;
+
+    unsigned long long GetUploadBytes(DrawAreaBatcher *area) const;
+    unsigned long long GetUploadBytes(DrawAreaTexure *area) const;
+    unsigned GetResidentBytes(DrawAreaBatcher *area) const;
+    unsigned GetResidentBytes(DrawAreaTexure *area) const;
+    unsigned GetResidentBytes(DrawAreaHybrid *area) const;
+
+protected:
+    SharedPtr<UIElement>           root_;
+    WeakPtr<Texture2D>             lineTexture_;
+    IntRect                        lineRect_;
+    IntVector2                     areaSize_;
+
+    PODVector<UIBatch>             batches_;
+    PODVector<float>               vertexData_;
+    Vector<DrawBenchmarkResult>    results_;
+};
+
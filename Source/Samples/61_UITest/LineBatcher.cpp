@@ -184,6 +184,34 @@ void LineBatcher::ClearBatchList()
     batches_.Clear();
 }
 
+void LineBatcher::SetNumSpans(unsigned numSpans)
+{
+    spans_.Resize(numSpans);
+}
+
+void LineBatcher::DrawSpan(unsigned span, const PODVector<Vector2> &points)
+{
+    assert(span < spans_.Size() && points.Size() > 1 && "invalid span");
+
+    Vector2 a, b, c, d;
+
+    ClearBatchList();
+    rectVectorList_.Clear();
+
+    for ( unsigned i = 1; i < points.Size(); ++i )
+    {
+        LinePointsToQuadPoints(points[i - 1], points[i], a, b, c, d);
+        rectVectorList_.Push(RectVectors(a, b, c, d));
+    }
+
+    StitchQuadPoints();
+
+    // the span takes the geometry, the batch list is left empty for the next one
+    spans_[span].vertexData_.Swap(vertexData_);
+    spans_[span].batches_.Swap(batches_);
+    ClearBatchList();
+}
+
 void LineBatcher::CreateLineSegments()
 {
     Vector2 v0, v1;
@@ -314,6 +342,41 @@ void LineBatcher::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vert
         batch.vertexStart_ = beg;
         batch.vertexEnd_   = end;
     }
+
+    // span geometry is in element space, offset it to the current position
+    IntVector2 offset = GetScreenPosition();
+    float offsetX = (float)offset.x_;
+    float offsetY = (float)offset.y_;
+
+    for ( unsigned s = 0; s < spans_.Size(); ++s )
+    {
+        LineSpanGeometry &span = spans_[s];
+
+        for ( unsigned i = 0; i < span.batches_.Size(); ++i )
+        {
+            UIBatch batch      = span.batches_[ i ];
+            unsigned beg       = batch.vertexStart_;
+            unsigned end       = batch.vertexEnd_;
+            batch.vertexStart_ = vertexData.Size();
+            batch.vertexEnd_   = vertexData.Size() + (end - beg);
+
+            vertexData.Resize( batch.vertexEnd_ );
+            memcpy( &vertexData[ batch.vertexStart_ ], &span.vertexData_[ beg ], (end - beg) * sizeof(float) );
+
+            for ( unsigned v = batch.vertexStart_; v < batch.vertexEnd_; v += UI_VERTEX_SIZE )
+            {
+                vertexData[v]     += offsetX;
+                vertexData[v + 1] += offsetY;
+            }
+
+            batch.scissor_.left_   += offset.x_;
+            batch.scissor_.right_  += offset.x_;
+            batch.scissor_.top_    += offset.y_;
+            batch.scissor_.bottom_ += offset.y_;
+
+            UIBatch::AddOrMerge( batch, batches );
+        }
+    }
 }
 
 void LineBatcher::AddQuad(const Vector2 &a, const Vector2 &b, const Vector2 &c, const Vector2 &d)
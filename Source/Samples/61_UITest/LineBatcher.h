@@ -48,6 +48,13 @@ struct RectVectors
     Vector2 a, b, c, d;
 };
 
+// geometry of one span in span mode, kept in element space
+struct LineSpanGeometry
+{
+    PODVector<float>   vertexData_;
+    PODVector<UIBatch> batches_;
+};
+
 //=============================================================================
 //=============================================================================
 class LineBatcher : public UIElement
@@ -71,6 +78,7 @@ public:
     void SetLineRect(const IntRect& rect)   { lineImageRect_ = rect; }
     void SetLineData(Texture* texture, const IntRect& rect);
     void SetLinePixelSize(float pixelSize)  { linePixelSize_ = pixelSize; }
+    float GetLinePixelSize() const          { return linePixelSize_; }
     void SetLineOpacity(float opacity);
     void SetLineType(LineType lineType);
     LineType GetLineType() const { return lineType_; }
@@ -84,6 +92,15 @@ public:
     void ClearPointList();
     void ClearBatchList();
     int GetBatchCount() const { return (int)batches_.Size(); }
+    const PODVector<float>& GetVertexData() const  { return vertexData_; }
+    const PODVector<UIBatch>& GetBatchList() const { return batches_; }
+
+    // span mode: every span keeps its own geometry, so an edit only re-tessellates
+    // the spans it touches. points are relative to the element and placed at draw
+    // time, moving the element doesn't re-tessellate anything
+    void SetNumSpans(unsigned numSpans);
+    unsigned GetNumSpans() const { return spans_.Size(); }
+    void DrawSpan(unsigned span, const PODVector<Vector2> &points);
 
     // virtual override
     virtual void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor);
@@ -121,5 +138,7 @@ protected:
     PODVector<RectVectors>  rectVectorList_;
     PODVector<float>        vertexData_;
     PODVector<UIBatch>      batches_;
+
+    Vector<LineSpanGeometry> spans_;
 };
 
@@ -33,39 +33,50 @@
 #include <Urho3D/Graphics/Renderer.h>
 #include <Urho3D/Graphics/Zone.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/Log.h>
 
 #include "Main.h"
 
 #include "PageManager.h"
+#include "PageLayout.h"
 #include "RadialGroup.h"
 #include "TabGroup.h"
+#include "UIStyleSheet.h"
 #include "SpriteAnimBox.h"
 #include "LineBatcher.h"
 #include "LineComponent.h"
 #include "DrawTool.h"
+#include "DrawToolBenchmark.h"
 
 #include "GraphNode.h"
+#include "GraphNodeRegistry.h"
 #include "SlideVarInput.h"
 #include "SlideVarNode.h"
 #include "TimeVarInput.h"
 #include "TimeVarNode.h"
 #include "InputNode.h"
 #include "OutputNode.h"
+#include "GraphProgram.h"
 
 #include <Urho3D/DebugNew.h>
 //=============================================================================
 //=============================================================================
 URHO3D_DEFINE_APPLICATION_MAIN(Main)
 
+#define INFO_PAGE_LAYOUT    "InfoPage.ulyt"
+
 //=============================================================================
 //=============================================================================
 Main::Main(Context* context) :
-    Sample(context)
+    Sample(context),
+    benchmarkMode_(false)
 {
     PageManager::RegisterObject(context);
 
     RadialGroup::RegisterObject(context);
     TabGroup::RegisterObject(context);
+    UIStyleSheet::RegisterObject(context);
     SpriteAnimBox::RegisterObject(context);
     LineBatcher::RegisterObject(context);
     StaticLine::RegisterObject(context);
@@ -84,10 +95,26 @@ void Main::Setup()
     engineParameters_["Headless"]     = false;
     engineParameters_["WindowWidth"]  = 1280; 
     engineParameters_["WindowHeight"] = 720;
+
+    // -benchmark: compare the draw tool backends headless and exit
+    benchmarkMode_ = GetArguments().Contains("-benchmark");
+
+    if ( benchmarkMode_ )
+    {
+        engineParameters_["Headless"] = true;
+    }
 }
 
 void Main::Start()
 {
+    if ( benchmarkMode_ )
+    {
+        SharedPtr<DrawToolBenchmark> benchmark(new DrawToolBenchmark(context_));
+        benchmark->Run();
+        engine_->Exit();
+        return;
+    }
+
     // Execute base class startup
     Sample::Start();
 
@@ -116,7 +143,7 @@ void Main::Start()
 void Main::CreatePageManager()
 {
     PageManager *pageManager = GetSubsystem<PageManager>();
-    pageManager->CreatePages(2);
+    pageManager->CreatePages(3);
 }
 
 void Main::CreateGUI()
@@ -126,21 +153,105 @@ void Main::CreateGUI()
     UIElement* root = ui->GetRoot();
     root->SetDefaultStyle(cache->GetResource<XMLFile>("UI/DefaultStyle.xml"));
 
-    CreateRadialGroup();
-    CreateTabGroup();
-    CreateSpriteAnimBox();
-    CreateLineComponents();
-    CreateDrawTool();
-
-    // set page
+    // pages are built in time slices, the first page is shown once it's done
+    // and the second one continues building in the background
     PageManager *pageManager = GetSubsystem<PageManager>();
-    pageManager->SetPageIndex(1);
+    pageManager->SetPageBuilder(0, PAGE_BUILD_STEPS(Main, BuildWidgetPage));
+    pageManager->SetPageBuilder(1, PAGE_BUILD_STEPS(Main, BuildNodeGraphPage));
+
+    // sprites the node graph page creates at runtime, loaded when it's warmed
+    pageManager->AddPageResource(1, Texture2D::GetTypeStatic(), "Urho2D/Ball.png");
+
+    // the info page is static: baked to a binary layout the first time it's built
+    // and instantiated from that on later runs, the builder stays as the fallback
+    FileSystem *fileSystem = GetSubsystem<FileSystem>();
+    infoPageLayout_ = fileSystem->GetAppPreferencesDir("urho3d", GetTypeName()) + INFO_PAGE_LAYOUT;
 
-    CreateSliderBarInput();
-    CreateNodeGraph();
+    pageManager->SetPageBuilder(2, PAGE_BUILDER(Main, BuildInfoPage));
+
+    if ( fileSystem->FileExists(infoPageLayout_) )
+    {
+        pageManager->SetPageLayout(2, infoPageLayout_);
+    }
 
     // set page
     pageManager->SetPageIndex(0);
+    pageManager->QueuePageBuild(1);
+}
+
+bool Main::BuildWidgetPage(UIElement *pageRoot, unsigned step)
+{
+    // one widget group per step
+    switch ( step )
+    {
+    case 0: CreateRadialGroup();    break;
+    case 1: CreateTabGroup();       break;
+    case 2: CreateSpriteAnimBox();  break;
+    case 3: CreateLineComponents(); break;
+    case 4: CreateDrawTool();       break;
+    }
+
+    return step >= 4;
+}
+
+bool Main::BuildNodeGraphPage(UIElement *pageRoot, unsigned step)
+{
+    // one graph node per step, the processor last once the graph is connected
+    switch ( step )
+    {
+    case 0: CreateSliderBarInput();     break;
+    case 1: CreateNodeGraphCollector(); break;
+    case 2: CreateNodeGraphSpawner();   break;
+    case 3: CreateNodeGraphXYInput();   break;
+    case 4: CreateNodeGraphFitInput();  break;
+    case 5: CreateNodeGraphProcessor(); break;
+    }
+
+    return step >= 5;
+}
+
+void Main::BuildInfoPage(UIElement *pageRoot)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Font *font = cache->GetResource<Font>("Fonts/Anonymous Pro.ttf");
+
+    // attribute state only, so that the page round-trips through its layout
+    BorderImage *panel = pageRoot->CreateChild<BorderImage>();
+    panel->SetTexture(cache->GetResource<Texture2D>("Textures/UI.png"));
+    panel->SetImageRect(IntRect(48, 0, 64, 16));
+    panel->SetBorder(IntRect(4, 4, 4, 4));
+    panel->SetColor(Color(0.2f, 0.2f, 0.3f, 0.9f));
+    panel->SetPosition(120, 120);
+    panel->SetSize(600, 240);
+    panel->SetLayout(LM_VERTICAL, 8, IntRect(16, 16, 16, 16));
+
+    Text *header = panel->CreateChild<Text>();
+    header->SetFont(font, 14);
+    header->SetText("UI Test");
+    header->SetColor(Color(0.9f, 0.9f, 0.0f));
+
+    const char *lines[] =
+    {
+        "page 1: radial group, tabs, sprite animation, control lines and draw tools",
+        "page 2: node graph, connect the inputs to spawn and move the balls",
+        "page 3: this page, built once and loaded from a binary layout after that",
+    };
+
+    for ( unsigned i = 0; i < sizeof(lines)/sizeof(lines[0]); ++i )
+    {
+        Text *text = panel->CreateChild<Text>();
+        text->SetFont(font, 11);
+        text->SetText(lines[i]);
+    }
+
+    // baked for the next run
+    SharedPtr<PageLayout> pageLayout(new PageLayout(context_));
+    File file(context_, infoPageLayout_, FILE_WRITE);
+
+    if ( !file.IsOpen() || !pageLayout->SaveLayout(pageRoot, file) )
+    {
+        URHO3D_LOGWARNING("Main: could not save the info page layout");
+    }
 }
 
 void Main::CreateRadialGroup()
@@ -171,6 +282,33 @@ void Main::CreateRadialGroup()
     }
 
     radialGroup->SetEnabled(true);
+
+    // virtualized group, only the visible rows have widgets
+    RadialGroup *virtualGroup = root->CreateChild<RadialGroup>();
+    virtualGroup->SetPosition(20, 240);
+    virtualGroup->SetSize(300, 150);
+    virtualGroup->SetColor(Color(1.0f, 0.66f, 0.0f));
+    virtualGroup->GetTitleTextElement()->SetColor(Color(0.0f, 0.4f, 0.7f));
+    virtualGroup->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 12);
+    virtualGroup->SetHeaderText("Virtual Radial Group");
+
+    Vector<String> labels;
+    for (int i = 0; i < 5000; ++i)
+    {
+        labels.Push(String("option ") + String(i+1));
+    }
+    virtualGroup->SetVirtualItems(labels, 5);
+
+    for (unsigned i = 0; i < 5; ++i)
+    {
+        RadialElement *radElem = virtualGroup->GetRadialButtonDesc(i);
+
+        radElem->textDesc_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+        radElem->textDesc_->SetColor(Color(0.0f, 0.4f, 0.7f));
+        radElem->checkbox_->SetColor(Color(0.0f, 0.8f, 0.8f));
+    }
+
+    virtualGroup->SetEnabled(true);
     SubscribeToEvent(E_RADIALGROUPTOGGLED, URHO3D_HANDLER(Main, HandleRadialGroupToggled));
 }
 
@@ -202,26 +340,34 @@ void Main::CreateTabGroup()
     {
         String tabLabel = String("tab ") + String(i+1);
 
-        TabElement *tabElement = tabgroup->CreateTab(tabSize, tabBodySize);
+        TabElement *tabElement = tabgroup->CreateTab(tabSize, tabBodySize, TAB_BODY_BUILDER(Main, BuildTabBody));
         tabElement->tabText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
         tabElement->tabText_->SetText(tabLabel);
         tabElement->tabText_->SetColor(Color(0.9f, 0.9f, 0.0f));
 
         tabElement->tabButton_->SetColor(Color(0.3f,0.7f,0.3f));
-        tabElement->tabBody_->SetColor(Color(0.3f,0.7f,0.3f));
-
-        Text *bodyText = tabElement->tabBody_->CreateChild<Text>();
-        bodyText->SetAlignment(HA_CENTER, VA_CENTER);
-        bodyText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 16);
-        String btext = "Tab body " + String(i+1);
-        bodyText->SetText(btext);
-        bodyText->SetColor(Color(0.9f, 0.9f, 0.0f));
     }
 
+    // bodies are built when first selected, keep at most two hidden ones around
+    tabgroup->SetMaxResidentBodies(2);
     tabgroup->SetEnabled(true);
     SubscribeToEvent(E_TABSELECTED, URHO3D_HANDLER(Main, HandleTabSelected));
 }
 
+void Main::BuildTabBody(BorderImage *tabBody, unsigned idx)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    tabBody->SetColor(Color(0.3f,0.7f,0.3f));
+
+    Text *bodyText = tabBody->CreateChild<Text>();
+    bodyText->SetAlignment(HA_CENTER, VA_CENTER);
+    bodyText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 16);
+    String btext = "Tab body " + String(idx+1);
+    bodyText->SetText(btext);
+    bodyText->SetColor(Color(0.9f, 0.9f, 0.0f));
+}
+
 void Main::CreateSpriteAnimBox()
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
@@ -238,11 +384,13 @@ void Main::CreateSpriteAnimBox()
     animbox->SetColor(Color(0,0,0,0));
     animbox->SetPosition(800, 120);
 
-    animbox->AddSprite("Urho2D/GoldIcon/1.png");
-    animbox->AddSprite("Urho2D/GoldIcon/2.png");
-    animbox->AddSprite("Urho2D/GoldIcon/3.png");
-    animbox->AddSprite("Urho2D/GoldIcon/4.png");
-    animbox->AddSprite("Urho2D/GoldIcon/5.png");
+    Vector<String> spriteFiles;
+    spriteFiles.Push("Urho2D/GoldIcon/1.png");
+    spriteFiles.Push("Urho2D/GoldIcon/2.png");
+    spriteFiles.Push("Urho2D/GoldIcon/3.png");
+    spriteFiles.Push("Urho2D/GoldIcon/4.png");
+    spriteFiles.Push("Urho2D/GoldIcon/5.png");
+    animbox->AddPackedSprites(spriteFiles, "GoldIconAtlas");
 
     animbox->SetFPS(20.0f);
     animbox->SetEnabled(true);
@@ -300,7 +448,7 @@ void Main::CreateDrawTool()
     // texture draw tool
     DrawTool *drawtoolTexture = root->CreateChild<DrawTool>();
 
-    if ( drawtoolTexture->Create( IntVector2(500, 330), uiTex2d, rect, false) )
+    if ( drawtoolTexture->Create( IntVector2(500, 330), uiTex2d, rect, DRAWAREA_TEXTURE) )
     {
         drawtoolTexture->SetPosition(700, 350);
         drawtoolTexture->SetColor(Color(0.2f,0.2f,0.2f));
@@ -309,17 +457,29 @@ void Main::CreateDrawTool()
     }
 #endif
 
+    // hybrid draw tool
+    DrawTool *drawtoolHybrid = root->CreateChild<DrawTool>();
+
+    if ( drawtoolHybrid->Create( IntVector2(500, 330), uiTex2d, rect, DRAWAREA_HYBRID) )
+    {
+        drawtoolHybrid->SetScreenColor(Color(0.8f, 0.95f, 0.2f));
+        drawtoolHybrid->SetPosition(700, 5);
+        drawtoolHybrid->SetColor(Color(0.2f,0.2f,0.2f));
+        drawtoolHybrid->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+        drawtoolHybrid->SetHeaderText("Drawtool Hybrid (right mouse click to draw)");
+    }
+
     // linebatcher draw tool
     DrawTool *drawtoolLineBatcher = root->CreateChild<DrawTool>();
 
-    if ( drawtoolLineBatcher->Create( IntVector2(500, 330), uiTex2d, rect, true) )
+    if ( drawtoolLineBatcher->Create( IntVector2(500, 330), uiTex2d, rect, DRAWAREA_LINEBATCHER) )
     {
         drawtoolLineBatcher->SetScreenColor(Color(0.8f, 0.95f, 0.2f));
         drawtoolLineBatcher->SetPosition(700, 365);
         //drawtoolLineBatcher->SetPosition(700, 5);
         drawtoolLineBatcher->SetColor(Color(0.2f,0.2f,0.2f));
         drawtoolLineBatcher->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
-        drawtoolLineBatcher->SetHeaderText("Drawtool LineBatcher (RMB to draw)");
+        drawtoolLineBatcher->SetHeaderText("Drawtool LineBatcher (RMB to draw, shift+RMB to erase)");
     }
 }
 
@@ -376,42 +536,58 @@ void Main::CreateSliderBarInput()
     slideVarNode->SetVarChangedCallback(colorChangedHelper, (VarChangedCallback)&UICallbackHelper::RedColorHandler);
 }
 
-void Main::CreateNodeGraph()
+void Main::CreateNodeGraphCollector()
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
+    GraphNodeRegistry* registry = GetSubsystem<GraphNodeRegistry>();
     PageManager* ui = GetSubsystem<PageManager>();
     UIElement* root = ui->GetRoot();
 
     //===========================================
     // input collector
     //===========================================
-    GraphNode *nodeBase5 = root->CreateChild<GraphNode>();
+    // set up once, a rebuilt page instantiates from the same prototype
+    if ( !registry->HasPrototype("InputSum") )
+    {
+        GraphNode *prototype = registry->CreatePrototype("InputSum");
+        prototype->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+        prototype->SetHeaderText("Input sum");
+
+        // footer info
+        prototype->SetFooterVisible(true);
+        prototype->SetFooterFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+        prototype->SetFooterText("-input XYi is locked\n"
+                                 "-the 'out' node is also locked\n"
+                                 "but still can pull data from it\n");
+
+        IntVector2 size25(GraphNode::GetDefaultIONodeSize());
+        registry->AddPrototypePort("InputSum", IOTYPE_INPUT, "Ni", size25);
+        registry->AddPrototypePort("InputSum", IOTYPE_INPUT, "XYi", size25);
+        registry->AddPrototypePort("InputSum", IOTYPE_OUTPUT, "out", size25);
+    }
 
-    IntVector2 pos01(350, 350);
-    nodeBase5->SetPosition( pos01 );
-    nodeBase5->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
-    nodeBase5->SetHeaderText("Input sum");
+    SharedPtr<GraphNode> nodeBase5 = registry->Instantiate("InputSum", root);
 
-    // footer info
-    nodeBase5->SetFooterVisible(true);
-    nodeBase5->SetFooterFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
-    nodeBase5->SetFooterText("-inputs Xi and Yi are locked\n"
-                             "-the 'out' node is also locked\n"
-                             "but still can pull data from it\n");
+    if ( nodeBase5 == NULL )
+        return;
 
-    IntVector2 size25(GraphNode::GetDefaultIONodeSize());
-    InputNode *inputNode0 = nodeBase5->CreateChild<InputNode>();
-    inputNode0->Create("Ni", size25);
+    IntVector2 pos01(350, 350);
+    nodeBase5->SetPosition( pos01 );
 
-    InputNode *inputNodeX = nodeBase5->CreateChild<InputNode>();
-    inputNodeX->Create("Xi", size25);
+    // the only output
+    OutputNode *outNode2 = static_cast<OutputNode*>(nodeBase5->GetOutputBodyElement()->GetChild(0));
+    outNode2->SetEnableCtrlButton(false); // lock
 
-    InputNode *inputNodeY = nodeBase5->CreateChild<InputNode>();
-    inputNodeY->Create("Yi", size25);
+    // picked up by the later build steps
+    graphInputXY_ = static_cast<InputNode*>(nodeBase5->GetInputElement("XYi"));
+    graphOutput_ = outNode2;
+}
 
-    OutputNode *outNode2 = nodeBase5->CreateChild<OutputNode>();
-    outNode2->Create("out", size25);
-    outNode2->SetEnableCtrlButton(false); // lock
+void Main::CreateNodeGraphSpawner()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    PageManager* ui = GetSubsystem<PageManager>();
+    UIElement* root = ui->GetRoot();
 
     //===========================================
     // ball spwaning node
@@ -433,67 +609,96 @@ void Main::CreateNodeGraph()
     slideVarNode->SetRange((Variant)1, (Variant)30);
     slideVarNode->SetCurrentValue((Variant)1);
     slideVarNode->SetSensitivity(0.1f);
+}
+
+void Main::CreateNodeGraphXYInput()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    PageManager* ui = GetSubsystem<PageManager>();
+    UIElement* root = ui->GetRoot();
 
     //===========================================
-    // X variance
+    // XY variance
     //===========================================
     IntVector2 pos00(20,340);
-    TimeVarNode *timeVarNodeX = root->CreateChild<TimeVarNode>();
-    timeVarNodeX->SetPosition(pos00);
-    timeVarNodeX->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
-    timeVarNodeX->SetHeaderText("Vary X input");
+    TimeVarNode *timeVarNodeXY = root->CreateChild<TimeVarNode>();
+    timeVarNodeXY->SetPosition(pos00);
+    timeVarNodeXY->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+    timeVarNodeXY->SetHeaderText("Vary XY input");
 
     // footer info (off by default)
-    timeVarNodeX->SetFooterVisible(true);
-    timeVarNodeX->SetFooterFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
-    timeVarNodeX->SetFooterText("-drag the small yellow\nsquares to adjust the curve");
+    timeVarNodeXY->SetFooterVisible(true);
+    timeVarNodeXY->SetFooterFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+    timeVarNodeXY->SetFooterText("-drag the small yellow\nsquares to adjust the curves\n"
+                                 "-red is X, green is Y\n"
+                                 "-note: moving in +y on the\nmain screen means moving\ntowards the bottom");
 
     // create timed input
-    IntVector2 size(200, 100);
-    timeVarNodeX->CreateTimeVarInput("X", size);
-    timeVarNodeX->SetScreenColor(Color(0.7f, 0.4f, 0.4f) );
+    IntVector2 size(200, 160);
+    timeVarNodeXY->CreateTimeVarInput("XY", size);
+    timeVarNodeXY->SetScreenColor(Color(0.7f, 0.4f, 0.4f) );
 
-    // curve points
+    // curve points, two channels on one time axis
     // specifies: time range, values per time and min/max
     // requires the star time = 0
-    PODVector<Vector2> curvePoints(5);
-    curvePoints[0] = Vector2(0.0f, -200.0f);
-    curvePoints[1] = Vector2(1.0f,  180.0f);
-    curvePoints[2] = Vector2(2.0f,  190.0f);
-    curvePoints[3] = Vector2(3.0f, -110.0f);
-    curvePoints[4] = Vector2(4.0f, -200.0f);
+    const float keyTimes[5]  = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f };
+    const float keyValues[10] = { -200.0f,  150.0f,
+                                   180.0f,  150.0f,
+                                   190.0f, -150.0f,
+                                  -110.0f,  180.0f,
+                                  -200.0f,  150.0f };
+    PODVector<float> curveTimes(keyTimes, 5);
+    PODVector<float> curveValues(keyValues, 10);
+
+    timeVarNodeXY->InitDataCurveChannels(curveTimes, curveValues, 2);
+    timeVarNodeXY->ConnectToInput(graphInputXY_); // connect input
+    timeVarNodeXY->SetEnableCtrlButton(false); // lock
+}
 
-    timeVarNodeX->InitDataCurvePoints(curvePoints);
-    timeVarNodeX->ConnectToInput(inputNodeX); // connect input
-    timeVarNodeX->SetEnableCtrlButton(false); // lock
+void Main::CreateNodeGraphFitInput()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    PageManager* ui = GetSubsystem<PageManager>();
+    UIElement* root = ui->GetRoot();
 
     //===========================================
-    // Y variance
+    // fitted recording
     //===========================================
-    IntVector2 posy(20,510);
-    TimeVarNode *timeVarNodeY = root->CreateChild<TimeVarNode>();
-    timeVarNodeY->SetPosition(posy);
-    timeVarNodeY->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
-    timeVarNodeY->SetHeaderText("Vary Y input");
+    IntVector2 pos00(350,60);
+    TimeVarNode *timeVarNodeFit = root->CreateChild<TimeVarNode>();
+    timeVarNodeFit->SetPosition(pos00);
+    timeVarNodeFit->SetHeaderFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+    timeVarNodeFit->SetHeaderText("Fitted recording");
 
-    // footer info (off by default)
-    timeVarNodeY->SetFooterVisible(true);
-    timeVarNodeY->SetFooterFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
-    timeVarNodeY->SetFooterText("-note: moving in +y on the\nmain screen means moving\ntowards the bottom");
+    // footer info
+    timeVarNodeFit->SetFooterVisible(true);
+    timeVarNodeFit->SetFooterFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 10);
+    timeVarNodeFit->SetFooterText("-a damped wave sampled at 30hz\nreduced to a few keyframes\n"
+                                  "-baked into a lookup table");
 
-    // create timed input
-    IntVector2 sizey0(200, 100);
-    timeVarNodeY->CreateTimeVarInput("Y", sizey0);
-    timeVarNodeY->SetScreenColor(Color(0.7f, 0.4f, 0.4f) );
-    curvePoints[0].y_ =  150.0f;
-    curvePoints[1].y_ =  150.0f;
-    curvePoints[2].y_ = -150.0f;
-    curvePoints[3].y_ =  180.0f;
-    curvePoints[4].y_ =  150.0f;
-
-    timeVarNodeY->InitDataCurvePoints(curvePoints);
-    timeVarNodeY->ConnectToInput(inputNodeY); // connect input
-    timeVarNodeY->SetEnableCtrlButton(false); // lock
+    IntVector2 size(200, 120);
+    timeVarNodeFit->CreateTimeVarInput("F", size);
+    timeVarNodeFit->SetScreenColor(Color(0.4f, 0.4f, 0.7f) );
+
+    // stands in for recorded data, the fit lands a frame or so later
+    PODVector<Vector2> samples;
+
+    for ( int i = 0; i <= 120; ++i )
+    {
+        float t = (float)i / 30.0f;
+        samples.Push(Vector2(t, 100.0f * Sin(t * 180.0f) * Pow(0.6f, t)));
+    }
+
+    timeVarNodeFit->FitDataCurvePoints(samples, 10);
+
+    // queries go through the baked table once it lands
+    timeVarNodeFit->SetBakedMode(true);
+}
+
+void Main::CreateNodeGraphProcessor()
+{
+    PageManager* ui = GetSubsystem<PageManager>();
+    UIElement* root = ui->GetRoot();
 
     //===========================================
     // InputProcessor
@@ -512,6 +717,7 @@ void Main::CreateNodeGraph()
         };
     public:
         InputProcessor(Context *context) : UIElement(context) , 
+            slotN_(0), slotXY_(0), versionN_(M_MAX_UNSIGNED), versionXY_(M_MAX_UNSIGNED),
             ballCount_(0), numBallsShown_(0), dataSet_(false), 
             minTime_(0.0f), maxTime_(0.0f), 
             elapsedTimeAccum_(0.0f), limitFrameRate_(true)
@@ -526,8 +732,17 @@ void Main::CreateNodeGraph()
         void SetOutputConnection(OutputNode *outputNode)
         {
             outputNode_ = outputNode;
-            minTime_ = outputNode_->GetStartTime("Xi");
-            maxTime_ = outputNode_->GetEndTime("Xi");
+
+            // queries are resolved to slots once, evaluation goes through the compiled program
+            program_.SetOutput(outputNode);
+            slotN_ = program_.GetSlot("Ni");
+            slotXY_ = program_.GetSlot("XYi");
+
+            minTime_ = program_.GetStartTime(slotXY_);
+            maxTime_ = program_.GetEndTime(slotXY_);
+
+            versionN_ = M_MAX_UNSIGNED;
+            versionXY_ = M_MAX_UNSIGNED;
         }
 
         void Start()
@@ -545,12 +760,31 @@ void Main::CreateNodeGraph()
             if ( !IsVisible() || !GetParent()->IsVisible() )
                 return;
 
-            Variant var = outputNode_->GetCurrentValue("Ni");
-            ballCount_ = 0;
+            program_.Update();
+
+            // the inputs are only read again after an edit upstream
+            unsigned versionN = program_.GetSlotVersion(slotN_);
+
+            if ( versionN != versionN_ )
+            {
+                const Variant &var = program_.GetCurrentValue(slotN_);
+                ballCount_ = 0;
+
+                if (var != Variant::EMPTY )
+                {
+                    ballCount_ = var.GetInt();
+                }
 
-            if (var != Variant::EMPTY )
+                versionN_ = versionN;
+            }
+
+            unsigned versionXY = program_.GetSlotVersion(slotXY_);
+
+            if ( versionXY != versionXY_ )
             {
-                ballCount_ = var.GetInt();
+                minTime_ = program_.GetStartTime(slotXY_);
+                maxTime_ = program_.GetEndTime(slotXY_);
+                versionXY_ = versionXY;
             }
 
             elapsedTimeAccum_ += timeStep;
@@ -571,16 +805,33 @@ void Main::CreateNodeGraph()
 
         void UpdateBallPosition(float timeStep)
         {
-            for ( unsigned i = 0; i < numBallsShown_ && i < ballList_.Size(); ++i )
+            unsigned numBalls = Min(numBallsShown_, ballList_.Size());
+            unsigned numChannels = program_.GetNumChannels(slotXY_);
+
+            ballTimes_.Resize(numBalls);
+            ballXY_.Resize(numBalls * numChannels);
+
+            for ( unsigned i = 0; i < numBalls; ++i )
             {
                 ballList_[i].time += timeStep;
 
                 if ( ballList_[i].time > maxTime_) ballList_[i].time = 0.0f;
 
-                float x = outputNode_->GetValueAtTime("Xi", ballList_[i].time);
-                float y = outputNode_->GetValueAtTime("Yi", ballList_[i].time);
+                ballTimes_[i] = ballList_[i].time;
+            }
+
+            // one batch for both axes, x and y are interleaved
+            if ( numBalls )
+            {
+                program_.GetChannelValuesAtTimes(slotXY_, &ballTimes_[0], &ballXY_[0], numBalls);
+            }
+
+            for ( unsigned i = 0; i < numBalls; ++i )
+            {
+                const float *xy = &ballXY_[i * numChannels];
+                float y = numChannels > 1 ? xy[1] : 0.0f;
 
-                ballList_[i].sprite->SetPosition( ballList_[i].pos + Vector2(x, y) );
+                ballList_[i].sprite->SetPosition( ballList_[i].pos + Vector2(xy[0], y) );
             }
         }
 
@@ -643,7 +894,14 @@ void Main::CreateNodeGraph()
 
     protected:
         WeakPtr<OutputNode> outputNode_;
+        GraphProgram        program_;
+        int                 slotN_;
+        int                 slotXY_;
+        unsigned            versionN_;
+        unsigned            versionXY_;
         Vector<BallData>    ballList_;
+        PODVector<float>    ballTimes_;
+        PODVector<float>    ballXY_;
         unsigned            ballCount_;
         unsigned            numBallsShown_;
 
@@ -662,7 +920,7 @@ void Main::CreateNodeGraph()
     InputProcessor *inputProcessor = new InputProcessor(context_);
     root->AddChild(inputProcessor);
 
-    inputProcessor->SetOutputConnection(outNode2);
+    inputProcessor->SetOutputConnection(graphOutput_);
     inputProcessor->Start();
 }
 
@@ -26,10 +26,14 @@
 
 namespace Urho3D
 {
+    class BorderImage;
     class Node;
     class Scene;
 }
 
+class InputNode;
+class OutputNode;
+
 /// GUI test example.
 /// This sample demonstrates:
 ///     - Creating GUI elements from C++
@@ -54,12 +58,22 @@ protected:
     void CreateGUI();
     void CreateRadialGroup();
     void CreateTabGroup();
+    void BuildTabBody(BorderImage *tabBody, unsigned idx);
     void CreateLineComponents();
     void CreateSpriteAnimBox();
     void CreateDrawTool();
 
     void CreateSliderBarInput();
-    void CreateNodeGraph();
+    void CreateNodeGraphCollector();
+    void CreateNodeGraphSpawner();
+    void CreateNodeGraphXYInput();
+    void CreateNodeGraphFitInput();
+    void CreateNodeGraphProcessor();
+
+    /// Page build steps, run time-sliced by the page manager
+    bool BuildWidgetPage(UIElement *pageRoot, unsigned step);
+    bool BuildNodeGraphPage(UIElement *pageRoot, unsigned step);
+    void BuildInfoPage(UIElement *pageRoot);
 
     /// Construct an instruction text to the UI.
     void CreateInstructions();
@@ -75,4 +89,10 @@ protected:
 
 protected:
     Color   colorBackground_;
+    bool    benchmarkMode_;
+    String  infoPageLayout_;
+
+    /// Node graph ports shared between the page build steps
+    WeakPtr<InputNode>  graphInputXY_;
+    WeakPtr<OutputNode> graphOutput_;
 };
@@ -0,0 +1,352 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Math/MathDefs.h>
+
+#include <math.h>
+
+#include "CurveFitter.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+// a sample depends on the keys span - 1 .. span + 2
+#define SPAN_KEYS   4
+
+//=============================================================================
+//=============================================================================
+CurveFitter::CurveFitter()
+    : maxError_(0.0f)
+{
+}
+
+bool CurveFitter::Fit(const PODVector<Vector2> &samples, unsigned maxKeyframes, float maxError)
+{
+    keyframes_.Clear();
+    knotSamples_.Clear();
+    maxError_ = 0.0f;
+
+    unsigned numSamples = samples.Size();
+
+    if ( numSamples < 2 )
+        return false;
+
+    for ( unsigned i = 1; i < numSamples; ++i )
+    {
+        if ( samples[i].x_ <= samples[i - 1].x_ )
+            return false;
+    }
+
+    maxKeyframes = Clamp(maxKeyframes, 2U, numSamples);
+
+    // start from the end points and refine where the error is worst
+    knotSamples_.Push(0);
+    knotSamples_.Push(numSamples - 1);
+
+    for ( ;; )
+    {
+        if ( !SolveValues(samples) )
+        {
+            keyframes_.Clear();
+            return false;
+        }
+
+        MeasureErrors(samples);
+
+        if ( !SplitSpans(maxKeyframes, maxError) )
+            break;
+    }
+
+    return true;
+}
+
+void CurveFitter::UpdateTangentScales()
+{
+    // same tangents as CurveSpans::Build
+    unsigned numKeys = keyframes_.Size();
+
+    invTangentDt_.Resize(numKeys);
+
+    for ( unsigned i = 0; i < numKeys; ++i )
+    {
+        unsigned prev = i > 0 ? i - 1 : 0;
+        unsigned next = i + 1 < numKeys ? i + 1 : numKeys - 1;
+        float dt = keyframes_[next].x_ - keyframes_[prev].x_;
+
+        if ( i == 0 || i == numKeys - 1 )
+            dt *= 2.0f;
+
+        invTangentDt_[i] = dt > 0.0f ? 1.0f / dt : 0.0f;
+    }
+}
+
+void CurveFitter::GetSampleWeights(unsigned span, float f, float *weights) const
+{
+    unsigned numKeys = keyframes_.Size();
+    float f2 = f * f;
+    float f3 = f2 * f;
+    float h = keyframes_[span + 1].x_ - keyframes_[span].x_;
+
+    weights[0] = 0.0f;
+    weights[1] = 2.0f * f3 - 3.0f * f2 + 1.0f;
+    weights[2] = -2.0f * f3 + 3.0f * f2;
+    weights[3] = 0.0f;
+
+    // each end tangent is the slope between the neighbors of that key
+    for ( unsigned e = 0; e < 2; ++e )
+    {
+        unsigned key = span + e;
+        unsigned prev = key > 0 ? key - 1 : 0;
+        unsigned next = key + 1 < numKeys ? key + 1 : numKeys - 1;
+        float basis = e == 0 ? f3 - 2.0f * f2 + f : f3 - f2;
+        float scale = basis * h * invTangentDt_[key];
+
+        weights[next + 1 - span] += scale;
+        weights[prev + 1 - span] -= scale;
+    }
+}
+
+bool CurveFitter::SolveValues(const PODVector<Vector2> &samples)
+{
+    unsigned numKeys = knotSamples_.Size();
+    float weights[SPAN_KEYS];
+
+    keyframes_.Resize(numKeys);
+
+    for ( unsigned k = 0; k < numKeys; ++k )
+    {
+        keyframes_[k] = samples[knotSamples_[k]];
+    }
+
+    UpdateTangentScales();
+
+    band_.Resize(numKeys * SPAN_KEYS);
+    rhs_.Resize(numKeys);
+
+    for ( unsigned i = 0; i < band_.Size(); ++i )
+        band_[i] = 0.0;
+    for ( unsigned i = 0; i < rhs_.Size(); ++i )
+        rhs_[i] = 0.0;
+
+    // normal equations, a knot sample goes to the span on its right
+    for ( unsigned s = 0; s + 1 < numKeys; ++s )
+    {
+        float t0 = keyframes_[s].x_;
+        float invH = 1.0f / (keyframes_[s + 1].x_ - t0);
+        unsigned end = s + 2 < numKeys ? knotSamples_[s + 1] : knotSamples_[s + 1] + 1;
+
+        for ( unsigned j = knotSamples_[s]; j < end; ++j )
+        {
+            GetSampleWeights(s, (samples[j].x_ - t0) * invH, weights);
+
+            for ( unsigned a = 0; a < SPAN_KEYS; ++a )
+            {
+                int ka = (int)s - 1 + (int)a;
+
+                if ( ka < 0 || ka >= (int)numKeys || weights[a] == 0.0f )
+                    continue;
+
+                rhs_[ka] += (double)weights[a] * (double)samples[j].y_;
+
+                for ( unsigned b = a; b < SPAN_KEYS && ka + (int)(b - a) < (int)numKeys; ++b )
+                {
+                    band_[ka * SPAN_KEYS + (b - a)] += (double)weights[a] * (double)weights[b];
+                }
+            }
+        }
+    }
+
+    // a light pull towards the sampled value keeps keys with little support solvable
+    double trace = 0.0;
+
+    for ( unsigned k = 0; k < numKeys; ++k )
+        trace += band_[k * SPAN_KEYS];
+
+    double lambda = 1e-6 * trace / (double)numKeys + 1e-12;
+
+    for ( unsigned k = 0; k < numKeys; ++k )
+    {
+        band_[k * SPAN_KEYS] += lambda;
+        rhs_[k] += lambda * (double)keyframes_[k].y_;
+    }
+
+    // banded cholesky, L overwrites the lower band
+    for ( unsigned j = 0; j < numKeys; ++j )
+    {
+        unsigned k0 = j >= SPAN_KEYS - 1 ? j - (SPAN_KEYS - 1) : 0;
+        double d = band_[j * SPAN_KEYS];
+
+        for ( unsigned k = k0; k < j; ++k )
+        {
+            double l = band_[k * SPAN_KEYS + (j - k)];
+            d -= l * l;
+        }
+
+        if ( d <= 0.0 )
+            return false;
+
+        d = sqrt(d);
+        band_[j * SPAN_KEYS] = d;
+
+        for ( unsigned i = j + 1; i < numKeys && i - j < SPAN_KEYS; ++i )
+        {
+            unsigned m0 = i >= SPAN_KEYS - 1 ? i - (SPAN_KEYS - 1) : 0;
+            double v = band_[j * SPAN_KEYS + (i - j)];
+
+            for ( unsigned k = m0; k < j; ++k )
+            {
+                v -= band_[k * SPAN_KEYS + (i - k)] * band_[k * SPAN_KEYS + (j - k)];
+            }
+
+            band_[j * SPAN_KEYS + (i - j)] = v / d;
+        }
+    }
+
+    // L y = b, then L^T x = y
+    for ( unsigned i = 0; i < numKeys; ++i )
+    {
+        unsigned k0 = i >= SPAN_KEYS - 1 ? i - (SPAN_KEYS - 1) : 0;
+        double v = rhs_[i];
+
+        for ( unsigned k = k0; k < i; ++k )
+            v -= band_[k * SPAN_KEYS + (i - k)] * rhs_[k];
+
+        rhs_[i] = v / band_[i * SPAN_KEYS];
+    }
+
+    for ( unsigned i = numKeys; i-- > 0; )
+    {
+        double v = rhs_[i];
+
+        for ( unsigned k = i + 1; k < numKeys && k - i < SPAN_KEYS; ++k )
+            v -= band_[i * SPAN_KEYS + (k - i)] * rhs_[k];
+
+        rhs_[i] = v / band_[i * SPAN_KEYS];
+    }
+
+    for ( unsigned k = 0; k < numKeys; ++k )
+    {
+        keyframes_[k].y_ = (float)rhs_[k];
+    }
+
+    return true;
+}
+
+void CurveFitter::MeasureErrors(const PODVector<Vector2> &samples)
+{
+    unsigned numKeys = keyframes_.Size();
+    unsigned numSpans = numKeys - 1;
+    float weights[SPAN_KEYS];
+
+    spanErrors_.Resize(numSpans);
+    maxError_ = 0.0f;
+
+    for ( unsigned s = 0; s < numSpans; ++s )
+    {
+        float t0 = keyframes_[s].x_;
+        float invH = 1.0f / (keyframes_[s + 1].x_ - t0);
+
+        spanErrors_[s] = 0.0f;
+
+        for ( unsigned j = knotSamples_[s]; j <= knotSamples_[s + 1]; ++j )
+        {
+            GetSampleWeights(s, (samples[j].x_ - t0) * invH, weights);
+
+            float value = 0.0f;
+
+            for ( unsigned a = 0; a < SPAN_KEYS; ++a )
+            {
+                int ka = (int)s - 1 + (int)a;
+
+                if ( ka >= 0 && ka < (int)numKeys )
+                    value += weights[a] * keyframes_[ka].y_;
+            }
+
+            float err = Abs(value - samples[j].y_);
+
+            spanErrors_[s] = Max(spanErrors_[s], err);
+        }
+
+        maxError_ = Max(maxError_, spanErrors_[s]);
+    }
+}
+
+bool CurveFitter::SplitSpans(unsigned maxKeyframes, float maxError)
+{
+    unsigned numSpans = spanErrors_.Size();
+    unsigned budget = maxKeyframes - knotSamples_.Size();
+    PODVector<unsigned char> split(numSpans);
+    unsigned numCandidates = 0;
+
+    // a span can split if it's over the error and has a sample inside
+    for ( unsigned s = 0; s < numSpans; ++s )
+    {
+        split[s] = spanErrors_[s] > maxError && knotSamples_[s + 1] - knotSamples_[s] > 1;
+
+        if ( split[s] )
+            numCandidates++;
+    }
+
+    if ( numCandidates == 0 || budget == 0 )
+        return false;
+
+    // over budget: keep only the worst spans
+    if ( numCandidates > budget )
+    {
+        PODVector<unsigned char> picked(numSpans);
+
+        for ( unsigned s = 0; s < numSpans; ++s )
+            picked[s] = 0;
+
+        for ( unsigned n = 0; n < budget; ++n )
+        {
+            unsigned worst = M_MAX_UNSIGNED;
+
+            for ( unsigned s = 0; s < numSpans; ++s )
+            {
+                if ( split[s] && !picked[s] && (worst == M_MAX_UNSIGNED || spanErrors_[s] > spanErrors_[worst]) )
+                    worst = s;
+            }
+
+            picked[worst] = 1;
+        }
+
+        split.Swap(picked);
+    }
+
+    PODVector<unsigned> knots;
+
+    for ( unsigned s = 0; s < numSpans; ++s )
+    {
+        knots.Push(knotSamples_[s]);
+
+        if ( split[s] )
+        {
+            knots.Push((knotSamples_[s] + knotSamples_[s + 1]) / 2);
+        }
+    }
+
+    knots.Push(knotSamples_.Back());
+    knotSamples_.Swap(knots);
+
+    return true;
+}
+
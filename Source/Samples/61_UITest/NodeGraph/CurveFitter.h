@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/Container/Vector.h>
+#include <Urho3D/Math/Vector2.h>
+
+using namespace Urho3D;
+//=============================================================================
+//=============================================================================
+#define DEFAULT_FIT_MAX_KEYFRAMES   64
+
+//=============================================================================
+// fits a keyframe curve to dense (time, value) samples. the curve has the
+// same form as CurveSpans, so a keyframe value enters each sample linearly:
+// knots are placed on samples by halving the spans with the worst error,
+// and the keyframe values are solved by least squares (banded cholesky).
+// no engine state is touched, a fit can run on any thread
+//=============================================================================
+class CurveFitter
+{
+public:
+    CurveFitter();
+
+    // samples need increasing times. stops once every sample is within
+    // maxError or the curve has maxKeyframes keys, whichever comes first
+    bool Fit(const PODVector<Vector2> &samples, unsigned maxKeyframes, float maxError);
+
+    const PODVector<Vector2>& GetKeyframes() const { return keyframes_; }
+    float GetMaxError() const { return maxError_; }
+
+protected:
+    void UpdateTangentScales();
+    void GetSampleWeights(unsigned span, float f, float *weights) const;
+    bool SolveValues(const PODVector<Vector2> &samples);
+    void MeasureErrors(const PODVector<Vector2> &samples);
+    bool SplitSpans(unsigned maxKeyframes, float maxError);
+
+protected:
+    PODVector<Vector2>  keyframes_;
+    PODVector<unsigned> knotSamples_;
+    PODVector<float>    invTangentDt_;
+
+    PODVector<float>    spanErrors_;
+    float               maxError_;
+
+    // normal equations, lower band: band_[col * 4 + row - col]
+    PODVector<double>   band_;
+    PODVector<double>   rhs_;
+};
+
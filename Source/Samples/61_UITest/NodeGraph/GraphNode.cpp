@@ -41,6 +41,7 @@
 #include "TimeVarInput.h"
 #include "TimeVarNode.h"
 #include "SlideVarNode.h"
+#include "GraphNodeRegistry.h"
 
 #include <Urho3D/DebugNew.h>
 
@@ -59,6 +60,7 @@ void GraphNode::RegisterObject(Context* context)
     // register all node graph components
     NodeHeader::RegisterObject(context);
     InputNodeManager::RegisterObject(context);
+    GraphNodeRegistry::RegisterObject(context);
 
     // io elements
     IOElement::RegisterObject(context);
@@ -88,6 +90,9 @@ GraphNode::~GraphNode()
 
 bool GraphNode::InitInternal()
 {
+    // a single layout pass once all parts are in
+    DisableLayoutUpdate();
+
     SetLayoutBorder(IntRect(2,2,2,2));
     SetLayoutMode(LM_VERTICAL);
     UIElement::SetColor(colorHeader_);
@@ -131,6 +136,9 @@ bool GraphNode::InitInternal()
 
     footerText_ = footerElement_->CreateChild<Text>();
 
+    EnableLayoutUpdate();
+    UpdateLayout();
+
     return true;
 }
 
@@ -302,101 +310,113 @@ void NodeHeader::OnDragMove(const IntVector2& position, const IntVector2& screen
 
 //===============================================
 // related to timevar input
-float GraphNode::GetValueRangeMin(const String &varName)
+float GraphNode::GetValueRangeMin(StringHash varId)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetValueRangeMin(varName);
+        return elem->GetValueRangeMin(varId);
     }
     return 0.0f;
 }
 
-float GraphNode::GetValueRangeMax(const String &varName)
+float GraphNode::GetValueRangeMax(StringHash varId)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetValueRangeMax(varName);
+        return elem->GetValueRangeMax(varId);
     }
     return 0.0f;
 }
 
-float GraphNode::GetStartTime(const String &varName)
+float GraphNode::GetStartTime(StringHash varId)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetStartTime(varName);
+        return elem->GetStartTime(varId);
     }
     return 0.0f;
 }
 
-float GraphNode::GetEndTime(const String &varName)
+float GraphNode::GetEndTime(StringHash varId)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetEndTime(varName);
+        return elem->GetEndTime(varId);
     }
     return 0.0f;
 }
 
-float GraphNode::GetValueAtTime(const String &varName, float time)
+float GraphNode::GetValueAtTime(StringHash varId, float time)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetValueAtTime(varName, time);
+        return elem->GetValueAtTime(varId, time);
     }
     return 0.0f;
 }
 
+void GraphNode::GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n)
+{
+    IOElement *elem = FindInuptVarName(varId);
+
+    if ( elem )
+    {
+        elem->GetValuesAtTimes(varId, times, out, n);
+        return;
+    }
+    memset(out, 0, n * sizeof(float));
+}
+
 // related to slidevar input
-const Variant& GraphNode::GetRangeMin(const String &varName)
+const Variant& GraphNode::GetRangeMin(StringHash varId)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetRangeMin(varName);
+        return elem->GetRangeMin(varId);
     }
 
     return Variant::EMPTY;
 }
 
-const Variant& GraphNode::GetRangeMax(const String &varName)
+const Variant& GraphNode::GetRangeMax(StringHash varId)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetRangeMax(varName);
+        return elem->GetRangeMax(varId);
     }
 
     return Variant::EMPTY;
 }
 
-const Variant& GraphNode::GetCurrentValue(const String &varName)
+const Variant& GraphNode::GetCurrentValue(StringHash varId)
 {
-    IOElement *elem = FindInuptVarName(varName);
+    IOElement *elem = FindInuptVarName(varId);
 
     if ( elem )
     {
-        return elem->GetCurrentValue(varName);
+        return elem->GetCurrentValue(varId);
     }
 
     return Variant::EMPTY;
 }
 
-IOElement* GraphNode::FindInuptVarName(const String &varName)
+IOElement* GraphNode::FindInuptVarName(StringHash varId)
 {
-    HashMap<String, IOElement*>::Iterator itr = cacheVarNameToIOElement_.Find( varName );
+    HashMap<StringHash, IOElement*>::Iterator itr = cacheVarNameToIOElement_.Find( varId );
     IOElement *elem = NULL;
 
     if ( itr != cacheVarNameToIOElement_.End() )
@@ -411,9 +431,9 @@ IOElement* GraphNode::FindInuptVarName(const String &varName)
         // must be IOElement, no need to dynamically cast to be sure
         elem = (IOElement*)inputBodyElement_->GetChild(i);
 
-        if ( elem->GetVariableName() == varName )
+        if ( elem->GetVariableHash() == varId )
         {
-            cacheVarNameToIOElement_.Insert( Pair<String, IOElement*>(varName, elem) );
+            cacheVarNameToIOElement_.Insert( Pair<StringHash, IOElement*>(varId, elem) );
             return elem;
         }
     }
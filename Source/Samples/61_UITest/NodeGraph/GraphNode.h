@@ -83,17 +83,32 @@ public:
 
     void SetEnabled(bool enable);
 
+    IOElement* GetInputElement(StringHash varId)          { return FindInuptVarName(varId); }
+    IOElement* GetInputElement(const String &varName)     { return FindInuptVarName(StringHash(varName)); }
+
     // related to timevar input
-    virtual float GetValueRangeMin(const String &varName);
-    virtual float GetValueRangeMax(const String &varName);
-    virtual float GetStartTime(const String &varName);
-    virtual float GetEndTime(const String &varName);
-    virtual float GetValueAtTime(const String &varName, float time);
+    virtual float GetValueRangeMin(StringHash varId);
+    virtual float GetValueRangeMax(StringHash varId);
+    virtual float GetStartTime(StringHash varId);
+    virtual float GetEndTime(StringHash varId);
+    virtual float GetValueAtTime(StringHash varId, float time);
+    virtual void GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n);
 
     // related to slidevar input
-    virtual const Variant& GetRangeMin(const String &varName);
-    virtual const Variant& GetRangeMax(const String &varName);
-    virtual const Variant& GetCurrentValue(const String &varName);
+    virtual const Variant& GetRangeMin(StringHash varId);
+    virtual const Variant& GetRangeMax(StringHash varId);
+    virtual const Variant& GetCurrentValue(StringHash varId);
+
+    // string keyed wrappers, prefer the StringHash overloads with a precomputed hash
+    float GetValueRangeMin(const String &varName)             { return GetValueRangeMin(StringHash(varName));     }
+    float GetValueRangeMax(const String &varName)             { return GetValueRangeMax(StringHash(varName));     }
+    float GetStartTime(const String &varName)                 { return GetStartTime(StringHash(varName));         }
+    float GetEndTime(const String &varName)                   { return GetEndTime(StringHash(varName));           }
+    float GetValueAtTime(const String &varName, float time)   { return GetValueAtTime(StringHash(varName), time); }
+    void GetValuesAtTimes(const String &varName, const float *times, float *out, unsigned n) { GetValuesAtTimes(StringHash(varName), times, out, n); }
+    const Variant& GetRangeMin(const String &varName)         { return GetRangeMin(StringHash(varName));          }
+    const Variant& GetRangeMax(const String &varName)         { return GetRangeMax(StringHash(varName));          }
+    const Variant& GetCurrentValue(const String &varName)     { return GetCurrentValue(StringHash(varName));      }
 
 
     // mouse events
@@ -107,7 +122,7 @@ public:
                          int dragButtons, int releaseButton, Cursor* cursor);
 
 protected:
-    IOElement* FindInuptVarName(const String &varName);
+    IOElement* FindInuptVarName(StringHash varId);
 
 private:
     bool InitInternal();
@@ -137,7 +152,7 @@ protected:
     IntVector2            dragBeginCursor_;
 
     // input function
-    HashMap<String, IOElement*>   cacheVarNameToIOElement_;
+    HashMap<StringHash, IOElement*> cacheVarNameToIOElement_;
 };
 
 //=============================================================================
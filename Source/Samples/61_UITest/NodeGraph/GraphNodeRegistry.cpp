@@ -0,0 +1,210 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/UI/Font.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#include "GraphNodeRegistry.h"
+#include "InputNode.h"
+#include "OutputNode.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+void GraphNodeRegistry::RegisterObject(Context* context)
+{
+    context->RegisterSubsystem( new GraphNodeRegistry(context) );
+}
+
+GraphNodeRegistry::GraphNodeRegistry(Context *context)
+    : Object(context)
+{
+}
+
+GraphNodeRegistry::~GraphNodeRegistry()
+{
+}
+
+GraphNode* GraphNodeRegistry::CreatePrototype(const String &name, StringHash nodeType)
+{
+    SharedPtr<GraphNode> node(DynamicCast<GraphNode>(context_->CreateObject(nodeType)));
+
+    if ( node == NULL )
+        return NULL;
+
+    GraphNodePrototype &prototype = prototypes_[StringHash(name)];
+    prototype.template_ = node;
+    prototype.ports_.Clear();
+    prototype.attributes_.Clear();
+    prototype.prepared_ = false;
+
+    return node;
+}
+
+bool GraphNodeRegistry::AddPrototypePort(const String &name, IOType ioType, const String &variableName, const IntVector2 &size)
+{
+    HashMap<StringHash, GraphNodePrototype>::Iterator itr = prototypes_.Find(StringHash(name));
+
+    if ( itr == prototypes_.End() || ioType == IOTYPE_UNDEF )
+        return false;
+
+    IOPortDesc desc;
+    desc.ioType_ = ioType;
+    desc.variableName_ = variableName;
+    desc.size_ = size;
+    itr->second_.ports_.Push(desc);
+
+    return true;
+}
+
+bool GraphNodeRegistry::HasPrototype(const String &name) const
+{
+    return prototypes_.Contains(StringHash(name));
+}
+
+void GraphNodeRegistry::RemovePrototype(const String &name)
+{
+    prototypes_.Erase(StringHash(name));
+}
+
+SharedPtr<GraphNode> GraphNodeRegistry::Instantiate(const String &name, UIElement *parent)
+{
+    HashMap<StringHash, GraphNodePrototype>::Iterator itr = prototypes_.Find(StringHash(name));
+
+    if ( itr == prototypes_.End() || parent == NULL )
+        return SharedPtr<GraphNode>();
+
+    GraphNodePrototype &prototype = itr->second_;
+    SharedPtr<GraphNode> node(DynamicCast<GraphNode>(context_->CreateObject(prototype.template_->GetType())));
+
+    if ( node == NULL )
+        return SharedPtr<GraphNode>();
+
+    // hold off every layout in the node until it's fully populated
+    PODVector<UIElement*> elements;
+    elements.Push(node);
+    node->GetChildren(elements, true);
+
+    for ( unsigned i = 0; i < elements.Size(); ++i )
+    {
+        elements[i]->DisableLayoutUpdate();
+    }
+
+    // the first instance is still as constructed, diff the template against it
+    if ( !prototype.prepared_ )
+    {
+        PrepareAttributes(prototype.template_, node, elements, prototype);
+        prototype.prepared_ = true;
+    }
+
+    // bulk copy of the prepared list, applied once per element at the end
+    for ( unsigned i = 0; i < prototype.attributes_.Size(); ++i )
+    {
+        const PrototypeAttribute &attr = prototype.attributes_[i];
+        elements[attr.element_]->SetAttribute(attr.index_, attr.value_);
+    }
+
+    for ( unsigned i = 0; i < elements.Size(); ++i )
+    {
+        elements[i]->ApplyAttributes();
+    }
+
+    // io elements place their overlay boxes in screen space, so they need the parent first
+    parent->AddChild(node);
+
+    for ( unsigned i = 0; i < prototype.ports_.Size(); ++i )
+    {
+        const IOPortDesc &desc = prototype.ports_[i];
+
+        if ( desc.ioType_ == IOTYPE_INPUT )
+        {
+            node->CreateChild<InputNode>()->Create(desc.variableName_, desc.size_);
+        }
+        else
+        {
+            node->CreateChild<OutputNode>()->Create(desc.variableName_, desc.size_);
+        }
+    }
+
+    // deepest first so the parents see the final child sizes
+    for ( int i = (int)elements.Size() - 1; i >= 0; --i )
+    {
+        elements[i]->EnableLayoutUpdate();
+        elements[i]->UpdateLayout();
+    }
+
+    return node;
+}
+
+void GraphNodeRegistry::PrepareAttributes(UIElement *src, UIElement *dest, const PODVector<UIElement*> &elements, GraphNodePrototype &prototype)
+{
+    const Vector<AttributeInfo>* attributes = src->GetAttributes();
+    unsigned element = elements.IndexOf(dest);
+
+    if ( attributes && src->GetType() == dest->GetType() && element < elements.Size() )
+    {
+        for ( unsigned i = 0; i < attributes->Size(); ++i )
+        {
+            Variant value = src->GetAttribute(i);
+
+            if ( value == dest->GetAttribute(i) )
+                continue;
+
+            PrototypeAttribute attr;
+            attr.element_ = element;
+            attr.index_ = i;
+            attr.value_ = value;
+            prototype.attributes_.Push(attr);
+        }
+    }
+
+    // the internal children are created by the constructors so the trees line up
+    unsigned numChildren = Min(src->GetNumChildren(), dest->GetNumChildren());
+
+    for ( unsigned i = 0; i < numChildren; ++i )
+    {
+        PrepareAttributes(src->GetChild(i), dest->GetChild(i), elements, prototype);
+    }
+}
+
+Font* GraphNodeRegistry::GetLabelFont()
+{
+    if ( labelFont_ == NULL )
+    {
+        labelFont_ = GetSubsystem<ResourceCache>()->GetResource<Font>("Fonts/Anonymous Pro.ttf");
+    }
+
+    return labelFont_;
+}
+
+Texture2D* GraphNodeRegistry::GetUITexture()
+{
+    if ( uiTexture_ == NULL )
+    {
+        uiTexture_ = GetSubsystem<ResourceCache>()->GetResource<Texture2D>("Textures/UI.png");
+    }
+
+    return uiTexture_;
+}
+
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include "IOElement.h"
+
+namespace Urho3D
+{
+class Font;
+class Texture2D;
+}
+//=============================================================================
+//=============================================================================
+struct IOPortDesc
+{
+    IOType     ioType_;
+    String     variableName_;
+    IntVector2 size_;
+};
+
+struct PrototypeAttribute
+{
+    unsigned element_;
+    unsigned index_;
+    Variant  value_;
+};
+
+//=============================================================================
+// template node, built once and never shown. what it sets differently from a
+// freshly constructed node is captured on the first instance, later ones
+// replay that flat list
+//=============================================================================
+struct GraphNodePrototype
+{
+    GraphNodePrototype() : prepared_(false) {}
+
+    SharedPtr<GraphNode>       template_;
+    Vector<IOPortDesc>         ports_;
+
+    // element_ indexes the instance's depth-first element list
+    Vector<PrototypeAttribute> attributes_;
+    bool                       prepared_;
+};
+
+//=============================================================================
+// node type registry: a prototype is set up once through the template node,
+// instances copy its attributes in bulk with layout updates deferred until
+// the whole node is populated. also keeps the resources the io elements
+// share so that they aren't looked up per element.
+//=============================================================================
+class GraphNodeRegistry : public Object
+{
+    URHO3D_OBJECT(GraphNodeRegistry, Object);
+public:
+    static void RegisterObject(Context* context);
+
+    GraphNodeRegistry(Context *context);
+    virtual ~GraphNodeRegistry();
+
+    // returns the template to configure: colors, header and footer. configure it
+    // before the first Instantiate, the template is captured then
+    GraphNode* CreatePrototype(const String &name, StringHash nodeType = GraphNode::GetTypeStatic());
+    bool AddPrototypePort(const String &name, IOType ioType, const String &variableName, const IntVector2 &size);
+    bool HasPrototype(const String &name) const;
+    void RemovePrototype(const String &name);
+
+    // null if there's no such prototype or the node type can't be created
+    SharedPtr<GraphNode> Instantiate(const String &name, UIElement *parent);
+
+    Font* GetLabelFont();
+    Texture2D* GetUITexture();
+
+protected:
+    void PrepareAttributes(UIElement *src, UIElement *dest, const PODVector<UIElement*> &elements, GraphNodePrototype &prototype);
+
+protected:
+    HashMap<StringHash, GraphNodePrototype> prototypes_;
+
+    SharedPtr<Font>      labelFont_;
+    SharedPtr<Texture2D> uiTexture_;
+};
+
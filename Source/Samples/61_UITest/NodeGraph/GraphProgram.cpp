@@ -0,0 +1,314 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+
+#include "GraphProgram.h"
+#include "InputNodeManager.h"
+#include "InputNode.h"
+#include "OutputNode.h"
+#include "TimeVarInput.h"
+#include "SlideVarInput.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define MAX_RESOLVE_DEPTH   32
+
+//=============================================================================
+//=============================================================================
+GraphProgram::GraphProgram()
+    : version_(0)
+{
+    // op 0 is the null op, unresolved slots point at it
+    GraphOp nullOp = { GRAPHOP_NONE, NULL, &GraphProgram::EvalNone, &GraphProgram::BatchEvalNone };
+    ops_.Push(nullOp);
+}
+
+void GraphProgram::SetOutput(OutputNode *output)
+{
+    output_ = output;
+    manager_ = output ? output->GetSubsystem<InputNodeManager>() : NULL;
+    version_ = 0;
+
+    Compile();
+}
+
+int GraphProgram::GetSlot(const String &varName)
+{
+    for ( unsigned i = 0; i < slotNames_.Size(); ++i )
+    {
+        if ( slotNames_[i] == varName )
+            return (int)i;
+    }
+
+    slotNames_.Push(varName);
+    slotOps_.Push(0);
+    slotPorts_.Push(NULL);
+    slotFeeds_.Push(NULL);
+
+    // resolve the new slot right away
+    version_ = 0;
+    Update();
+
+    return (int)slotNames_.Size() - 1;
+}
+
+bool GraphProgram::Update()
+{
+    if ( manager_ == NULL )
+        return false;
+
+    if ( version_ != manager_->GetConnectionVersion() )
+    {
+        return Compile();
+    }
+
+    return true;
+}
+
+bool GraphProgram::Compile()
+{
+    ops_.Resize(1);
+
+    for ( unsigned i = 0; i < slotOps_.Size(); ++i )
+    {
+        slotOps_[i] = 0;
+        slotPorts_[i] = NULL;
+        slotFeeds_[i] = NULL;
+    }
+
+    if ( manager_ == NULL )
+        return false;
+
+    // nothing is resolved for a missing output, which is current as well
+    version_ = manager_->GetConnectionVersion();
+
+    if ( output_ == NULL || output_->GetNodeBasePtr() == NULL )
+        return false;
+
+    // every chain ends in a single source element, sources are shared between slots
+    for ( unsigned i = 0; i < slotNames_.Size(); ++i )
+    {
+        IOElement *source = ResolveSource(output_->GetNodeBasePtr(), slotNames_[i]);
+        slotPorts_[i] = output_->GetNodeBasePtr()->GetInputElement(slotNames_[i]);
+
+        if ( source )
+        {
+            slotOps_[i] = AddOp(source);
+
+            // a slot entering through a connected input is fed by that output port
+            IOElement *port = slotPorts_[i];
+
+            if ( port && port->IsInstanceOf<InputNode>() )
+            {
+                slotFeeds_[i] = static_cast<InputNode*>(port)->GetConnectedOutputNode();
+            }
+        }
+    }
+
+    return true;
+}
+
+bool GraphProgram::IsCurrent() const
+{
+    // without a manager nothing was resolved, every slot is on the null op
+    return manager_ == NULL || version_ == manager_->GetConnectionVersion();
+}
+
+IOElement* GraphProgram::ResolveSource(GraphNode *node, const String &varName)
+{
+    StringHash varId(varName);
+
+    // the depth limit guards against cycles
+    for ( int depth = 0; node && depth < MAX_RESOLVE_DEPTH; ++depth )
+    {
+        IOElement *elem = node->GetInputElement(varId);
+
+        if ( elem == NULL )
+            return NULL;
+
+        if ( !elem->IsInstanceOf<InputNode>() )
+            return elem;
+
+        OutputNode *outputNode = static_cast<InputNode*>(elem)->GetConnectedOutputNode();
+
+        if ( outputNode == NULL )
+            return NULL;
+
+        node = outputNode->GetNodeBasePtr();
+        varId = outputNode->GetVariableHash();
+    }
+
+    return NULL;
+}
+
+unsigned GraphProgram::AddOp(IOElement *source)
+{
+    for ( unsigned i = 1; i < ops_.Size(); ++i )
+    {
+        if ( ops_[i].source_ == source )
+            return i;
+    }
+
+    GraphOp op = { GRAPHOP_NONE, source, &GraphProgram::EvalNone, &GraphProgram::BatchEvalNone };
+
+    if ( source->IsInstanceOf<TimeVarInput>() )
+    {
+        op.type_ = GRAPHOP_TIMEVAR;
+        op.evalFn_ = &GraphProgram::EvalTimeVar;
+        op.batchEvalFn_ = &GraphProgram::BatchEvalTimeVar;
+    }
+    else if ( source->IsInstanceOf<SlideVarInput>() )
+    {
+        op.type_ = GRAPHOP_SLIDEVAR;
+    }
+
+    ops_.Push(op);
+
+    return ops_.Size() - 1;
+}
+
+float GraphProgram::EvalNone(IOElement *source, float time)
+{
+    return 0.0f;
+}
+
+float GraphProgram::EvalTimeVar(IOElement *source, float time)
+{
+    return ((TimeVarInput*)source)->GetValueAtTime(time);
+}
+
+void GraphProgram::BatchEvalNone(IOElement *source, const float *times, float *out, unsigned n)
+{
+    memset(out, 0, n * sizeof(float));
+}
+
+void GraphProgram::BatchEvalTimeVar(IOElement *source, const float *times, float *out, unsigned n)
+{
+    ((TimeVarInput*)source)->GetValuesAtTimes(times, out, n);
+}
+
+unsigned GraphProgram::GetNumChannels(int slot) const
+{
+    assert(IsCurrent());
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_TIMEVAR ? ((TimeVarInput*)op.source_)->GetNumChannels() : 1;
+}
+
+void GraphProgram::GetChannelValuesAtTimes(int slot, const float *times, float *out, unsigned n) const
+{
+    assert(IsCurrent());
+    const GraphOp &op = ops_[slotOps_[slot]];
+
+    if ( op.type_ == GRAPHOP_TIMEVAR )
+    {
+        ((TimeVarInput*)op.source_)->GetChannelValuesAtTimes(times, out, n);
+        return;
+    }
+
+    memset(out, 0, n * sizeof(float));
+}
+
+float GraphProgram::GetValueRangeMin(int slot) const
+{
+    assert(IsCurrent());
+    OutputNode *feed = slotFeeds_[slot];
+
+    if ( feed )
+        return feed->GetValueRangeMin(feed->GetVariableHash());
+
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_TIMEVAR ? ((TimeVarInput*)op.source_)->GetValueRangeMin() : 0.0f;
+}
+
+float GraphProgram::GetValueRangeMax(int slot) const
+{
+    assert(IsCurrent());
+    OutputNode *feed = slotFeeds_[slot];
+
+    if ( feed )
+        return feed->GetValueRangeMax(feed->GetVariableHash());
+
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_TIMEVAR ? ((TimeVarInput*)op.source_)->GetValueRangeMax() : 0.0f;
+}
+
+float GraphProgram::GetStartTime(int slot) const
+{
+    assert(IsCurrent());
+    OutputNode *feed = slotFeeds_[slot];
+
+    if ( feed )
+        return feed->GetStartTime(feed->GetVariableHash());
+
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_TIMEVAR ? ((TimeVarInput*)op.source_)->GetStartTime() : 0.0f;
+}
+
+float GraphProgram::GetEndTime(int slot) const
+{
+    assert(IsCurrent());
+    OutputNode *feed = slotFeeds_[slot];
+
+    if ( feed )
+        return feed->GetEndTime(feed->GetVariableHash());
+
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_TIMEVAR ? ((TimeVarInput*)op.source_)->GetEndTime() : 0.0f;
+}
+
+const Variant& GraphProgram::GetRangeMin(int slot) const
+{
+    assert(IsCurrent());
+    OutputNode *feed = slotFeeds_[slot];
+
+    if ( feed )
+        return feed->GetRangeMin(feed->GetVariableHash());
+
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_SLIDEVAR ? ((SlideVarInput*)op.source_)->GetRangeMin() : Variant::EMPTY;
+}
+
+const Variant& GraphProgram::GetRangeMax(int slot) const
+{
+    assert(IsCurrent());
+    OutputNode *feed = slotFeeds_[slot];
+
+    if ( feed )
+        return feed->GetRangeMax(feed->GetVariableHash());
+
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_SLIDEVAR ? ((SlideVarInput*)op.source_)->GetRangeMax() : Variant::EMPTY;
+}
+
+const Variant& GraphProgram::GetCurrentValue(int slot) const
+{
+    assert(IsCurrent());
+    OutputNode *feed = slotFeeds_[slot];
+
+    if ( feed )
+        return feed->GetCurrentValue(feed->GetVariableHash());
+
+    const GraphOp &op = ops_[slotOps_[slot]];
+    return op.type_ == GRAPHOP_SLIDEVAR ? ((SlideVarInput*)op.source_)->GetCurrentValue() : Variant::EMPTY;
+}
+
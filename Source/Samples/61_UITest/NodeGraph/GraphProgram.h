@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include "IOElement.h"
+
+class OutputNode;
+class InputNodeManager;
+
+//=============================================================================
+//=============================================================================
+typedef float (*TimeEvalFn)(IOElement *source, float time);
+typedef void (*TimeBatchEvalFn)(IOElement *source, const float *times, float *out, unsigned n);
+
+enum GraphOpType
+{
+    GRAPHOP_NONE,
+    GRAPHOP_TIMEVAR,
+    GRAPHOP_SLIDEVAR
+};
+
+struct GraphOp
+{
+    GraphOpType type_;
+    IOElement  *source_;
+    TimeEvalFn       evalFn_;
+    TimeBatchEvalFn  batchEvalFn_;
+};
+
+//=============================================================================
+// flat evaluation of the values reachable from an output node.
+// the InputNode -> OutputNode -> GraphNode forwarding is walked once at
+// compile time, each query slot then maps straight to the op of the source
+// element that produces it. slots stay valid across recompiles, which only
+// happen when InputNodeManager's connection version changes.
+// the ops and ports are raw pointers for the evaluation cost: removing an io
+// element bumps the connection version, so Update() has to run after any
+// graph change and before the next query. queries assert that it did.
+// the ranges and slide var values don't depend on time, they are asked from
+// the output port feeding the slot, whose per-frame cache answers repeats.
+//=============================================================================
+class GraphProgram
+{
+public:
+    GraphProgram();
+
+    void SetOutput(OutputNode *output);
+    int GetSlot(const String &varName);
+
+    // recompiles if the connections changed, call once per frame before evaluating
+    bool Update();
+    bool Compile();
+
+    // false if the connections changed since the last compile
+    bool IsCurrent() const;
+
+    bool IsConnected(int slot) const { assert(IsCurrent()); return ops_[slotOps_[slot]].type_ != GRAPHOP_NONE; }
+
+    // data version of the port a slot enters through, edits upstream are
+    // pushed to it. unchanged version, unchanged values
+    unsigned GetSlotVersion(int slot) const
+    {
+        assert(IsCurrent());
+        return slotPorts_[slot] ? slotPorts_[slot]->GetDataVersion() : 0;
+    }
+
+    float GetValueAtTime(int slot, float time) const
+    {
+        assert(IsCurrent());
+        const GraphOp &op = ops_[slotOps_[slot]];
+        return op.evalFn_(op.source_, time);
+    }
+
+    void GetValuesAtTimes(int slot, const float *times, float *out, unsigned n) const
+    {
+        assert(IsCurrent());
+        const GraphOp &op = ops_[slotOps_[slot]];
+        op.batchEvalFn_(op.source_, times, out, n);
+    }
+
+    // multi-channel sources, out is interleaved: n * GetNumChannels(slot) floats
+    unsigned GetNumChannels(int slot) const;
+    void GetChannelValuesAtTimes(int slot, const float *times, float *out, unsigned n) const;
+
+    float GetValueRangeMin(int slot) const;
+    float GetValueRangeMax(int slot) const;
+    float GetStartTime(int slot) const;
+    float GetEndTime(int slot) const;
+
+    const Variant& GetRangeMin(int slot) const;
+    const Variant& GetRangeMax(int slot) const;
+    const Variant& GetCurrentValue(int slot) const;
+
+    unsigned GetNumOps() const { return ops_.Size(); }
+
+protected:
+    static IOElement* ResolveSource(GraphNode *node, const String &varName);
+    unsigned AddOp(IOElement *source);
+
+    static float EvalNone(IOElement *source, float time);
+    static float EvalTimeVar(IOElement *source, float time);
+    static void BatchEvalNone(IOElement *source, const float *times, float *out, unsigned n);
+    static void BatchEvalTimeVar(IOElement *source, const float *times, float *out, unsigned n);
+
+protected:
+    WeakPtr<OutputNode>       output_;
+    WeakPtr<InputNodeManager> manager_;
+
+    Vector<String>            slotNames_;
+    PODVector<unsigned>       slotOps_;
+    PODVector<IOElement*>     slotPorts_;
+    PODVector<OutputNode*>    slotFeeds_;
+    PODVector<GraphOp>        ops_;
+    unsigned                  version_;
+};
+
@@ -33,6 +33,8 @@
 #include <SDL/SDL_log.h>
 
 #include "IOElement.h"
+#include "GraphNodeRegistry.h"
+#include "InputNodeManager.h"
 
 #include <Urho3D/DebugNew.h>
 //=============================================================================
@@ -44,10 +46,22 @@ void IOElement::RegisterObject(Context* context)
 
 IOElement::IOElement(Context *context) 
     : BorderImage(context)
+    , dataVersion_(0)
     , ioType_(IOTYPE_UNDEF) 
 {
 }
 
+IOElement::~IOElement()
+{
+    // compiled graph programs may point at this element
+    InputNodeManager *manager = GetSubsystem<InputNodeManager>();
+
+    if ( manager )
+    {
+        manager->BumpConnectionVersion();
+    }
+}
+
 bool IOElement::InitBaseNodeParent()
 {
     if ( FindBaseNodePtr() )
@@ -74,12 +88,11 @@ void IOElement::CreateTextLabel()
 {
     if ( labelText_ == NULL )
     {
-        ResourceCache* cache = GetSubsystem<ResourceCache>();
         SetLayoutBorder(IntRect(5,0,0,0));
 
         labelText_ = CreateChild<Text>();
         labelText_->SetAlignment(HA_CENTER, VA_TOP);
-        labelText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 8);
+        labelText_->SetFont(GetSubsystem<GraphNodeRegistry>()->GetLabelFont(), 8);
         labelText_->SetText("out");
     }
 }
@@ -95,7 +108,59 @@ void IOElement::SetTextLabel(const String& label)
 void IOElement::SetVariableName(const String& varName)
 {
     variableName_ = varName;
+    variableHash_ = StringHash(varName);
     SetTextLabel(varName);
+
+    InputNodeManager *manager = GetSubsystem<InputNodeManager>();
+
+    if ( manager )
+    {
+        manager->BumpConnectionVersion();
+    }
+
+    MarkDataChanged();
+}
+
+void IOElement::MarkDataChanged()
+{
+    InputNodeManager *manager = GetSubsystem<InputNodeManager>();
+
+    if ( manager )
+    {
+        PropagateDataChanged(manager->NextDataVersion());
+    }
+}
+
+void IOElement::PropagateDataChanged(unsigned version)
+{
+    // already stamped, the graph has a cycle
+    if ( dataVersion_ == version )
+        return;
+
+    dataVersion_ = version;
+
+    if ( GetIOType() != IOTYPE_INPUT || nodebaseParent_ == NULL )
+        return;
+
+    UIElement *outputBody = nodebaseParent_->GetOutputBodyElement();
+
+    if ( outputBody == NULL )
+        return;
+
+    const Vector<SharedPtr<UIElement> > &children = outputBody->GetChildren();
+
+    for ( unsigned i = 0; i < children.Size(); ++i )
+    {
+        if ( !children[i]->IsInstanceOf<IOElement>() )
+            continue;
+
+        IOElement *output = static_cast<IOElement*>(children[i].Get());
+
+        if ( output->GetIOType() == IOTYPE_OUTPUT )
+        {
+            output->PropagateDataChanged(version);
+        }
+    }
 }
 
 bool IOElement::FindBaseNodePtr()
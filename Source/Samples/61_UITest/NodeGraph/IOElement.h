@@ -43,7 +43,7 @@ public:
     static void RegisterObject(Context* context);
 
     IOElement(Context *context);
-    virtual ~IOElement(){}
+    virtual ~IOElement();
 
     IOType GetIOType() const { return ioType_; }
     GraphNode* GetNodeBasePtr() { return nodebaseParent_; }
@@ -51,23 +51,47 @@ public:
     // related to I/O
     void SetVariableName(const String& varName);
     const String& GetVariableName()         { return variableName_; }
+    StringHash GetVariableHash() const      { return variableHash_; }
+
+    // change tracking: an edit stamps a fresh version on the element and
+    // pushes it downstream along the connections, so a consumer only has to
+    // compare the version it saw last. versions are unique across elements
+    unsigned GetDataVersion() const                 { return dataVersion_; }
+    bool HasChangedSince(unsigned version) const    { return dataVersion_ != version; }
+    void MarkDataChanged();
 
     // related to timevar input
-    virtual float GetValueRangeMin(const String &varName){ return 0.0f; }
-    virtual float GetValueRangeMax(const String &varName){ return 0.0f; }
-    virtual float GetStartTime(const String &varName){ return 0.0f; }
-    virtual float GetEndTime(const String &varName){ return 0.0f; }
-    virtual float GetValueAtTime(const String &varName, float time){ return 0.0f; }
+    virtual float GetValueRangeMin(StringHash varId){ return 0.0f; }
+    virtual float GetValueRangeMax(StringHash varId){ return 0.0f; }
+    virtual float GetStartTime(StringHash varId){ return 0.0f; }
+    virtual float GetEndTime(StringHash varId){ return 0.0f; }
+    virtual float GetValueAtTime(StringHash varId, float time){ return 0.0f; }
+    virtual void GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n){ memset(out, 0, n * sizeof(float)); }
 
     // related to slidevar input
-    virtual const Variant& GetRangeMin(const String &varName){ return Variant::EMPTY; }
-    virtual const Variant& GetRangeMax(const String &varName){ return Variant::EMPTY; }
-    virtual const Variant& GetCurrentValue(const String &varName){ return Variant::EMPTY; }
+    virtual const Variant& GetRangeMin(StringHash varId){ return Variant::EMPTY; }
+    virtual const Variant& GetRangeMax(StringHash varId){ return Variant::EMPTY; }
+    virtual const Variant& GetCurrentValue(StringHash varId){ return Variant::EMPTY; }
+
+    // string keyed wrappers, prefer the StringHash overloads with a precomputed hash
+    float GetValueRangeMin(const String &varName)             { return GetValueRangeMin(StringHash(varName));     }
+    float GetValueRangeMax(const String &varName)             { return GetValueRangeMax(StringHash(varName));     }
+    float GetStartTime(const String &varName)                 { return GetStartTime(StringHash(varName));         }
+    float GetEndTime(const String &varName)                   { return GetEndTime(StringHash(varName));           }
+    float GetValueAtTime(const String &varName, float time)   { return GetValueAtTime(StringHash(varName), time); }
+    void GetValuesAtTimes(const String &varName, const float *times, float *out, unsigned n) { GetValuesAtTimes(StringHash(varName), times, out, n); }
+    const Variant& GetRangeMin(const String &varName)         { return GetRangeMin(StringHash(varName));          }
+    const Variant& GetRangeMax(const String &varName)         { return GetRangeMax(StringHash(varName));          }
+    const Variant& GetCurrentValue(const String &varName)     { return GetCurrentValue(StringHash(varName));      }
 
 
 protected:
     void SetIOType(IOType iotype) { ioType_ = iotype; }
 
+    // input side elements feed the node's outputs, OutputNode overrides this
+    // to feed its connected input
+    virtual void PropagateDataChanged(unsigned version);
+
     bool InitBaseNodeParent();
     bool SetBasePtrs(UIElement *nodebaseParent);
     bool FindBaseNodePtr();
@@ -85,6 +109,8 @@ protected:
     WeakPtr<GraphNode> nodebaseParent_;
     WeakPtr<Text>      labelText_;
     String             variableName_;
+    StringHash         variableHash_;
+    unsigned           dataVersion_;
 
 private:
     IOType ioType_;
@@ -36,6 +36,7 @@
 #include "InputNode.h"
 #include "OutputNode.h"
 #include "InputNodeManager.h"
+#include "GraphNodeRegistry.h"
 #include "PageManager.h"
 
 #include <Urho3D/DebugNew.h>
@@ -84,8 +85,7 @@ bool InputNode::Create(const String &variableName, const IntVector2 &size)
 
 bool InputNode::CreateInputbox()
 {
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-    Texture2D *tex2d = cache->GetResource<Texture2D>("Textures/UI.png");
+    Texture2D *tex2d = GetSubsystem<GraphNodeRegistry>()->GetUITexture();
     IntRect rect = LineBatcher::GetBoxRect();
     PageManager* ui = GetSubsystem<PageManager>();
     UIElement* root = ui->GetRoot();
@@ -144,93 +144,115 @@ void InputNode::SendReceiverMovedEvent()
 void InputNode::SetConnectedOutputNode(OutputNode *outputNode)
 {
     connectedOutputNode_ = outputNode;
-    connectedOutputVarName_.Clear();
+    connectedOutputVarHash_ = StringHash::ZERO;
+
+    // compiled graph programs resolve through this connection
+    InputNodeManager *manager = GetSubsystem<InputNodeManager>();
+
+    if ( manager )
+    {
+        manager->BumpConnectionVersion();
+    }
 
     if (connectedOutputNode_)
     {
-        connectedOutputVarName_ = connectedOutputNode_->GetVariableName();
+        connectedOutputVarHash_ = connectedOutputNode_->GetVariableHash();
     }
+
+    // what this input forwards is now different
+    MarkDataChanged();
 }
 
 //=========================================================
 // related to timevar input
-float InputNode::GetValueRangeMin(const String &varName)
+float InputNode::GetValueRangeMin(StringHash varId)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetValueRangeMin(connectedOutputVarName_);
+        return connectedOutputNode_->GetValueRangeMin(connectedOutputVarHash_);
     }
 
     return 0.0f;
 }
 
-float InputNode::GetValueRangeMax(const String &varName)
+float InputNode::GetValueRangeMax(StringHash varId)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetValueRangeMax(connectedOutputVarName_);
+        return connectedOutputNode_->GetValueRangeMax(connectedOutputVarHash_);
     }
 
     return 0.0f;
 }
 
-float InputNode::GetStartTime(const String &varName)
+float InputNode::GetStartTime(StringHash varId)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetStartTime(connectedOutputVarName_);
+        return connectedOutputNode_->GetStartTime(connectedOutputVarHash_);
     }
 
     return 0.0f;
 }
 
-float InputNode::GetEndTime(const String &varName)
+float InputNode::GetEndTime(StringHash varId)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetEndTime(connectedOutputVarName_);
+        return connectedOutputNode_->GetEndTime(connectedOutputVarHash_);
     }
 
     return 0.0f;
 }
 
-float InputNode::GetValueAtTime(const String &varName, float time)
+float InputNode::GetValueAtTime(StringHash varId, float time)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetValueAtTime(connectedOutputVarName_, time);
+        return connectedOutputNode_->GetValueAtTime(connectedOutputVarHash_, time);
     }
 
     return 0.0f;
 }
 
+void InputNode::GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n)
+{
+    if ( varId == variableHash_  && connectedOutputNode_)
+    {
+        connectedOutputNode_->GetValuesAtTimes(connectedOutputVarHash_, times, out, n);
+        return;
+    }
+
+    memset(out, 0, n * sizeof(float));
+}
+
 
 // related to slidevar input
-const Variant& InputNode::GetRangeMin(const String &varName)
+const Variant& InputNode::GetRangeMin(StringHash varId)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetRangeMin(connectedOutputVarName_);
+        return connectedOutputNode_->GetRangeMin(connectedOutputVarHash_);
     }
 
     return Variant::EMPTY;
 }
 
-const Variant& InputNode::GetRangeMax(const String &varName)
+const Variant& InputNode::GetRangeMax(StringHash varId)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetRangeMax(connectedOutputVarName_);
+        return connectedOutputNode_->GetRangeMax(connectedOutputVarHash_);
     }
 
     return Variant::EMPTY;
 }
 
-const Variant& InputNode::GetCurrentValue(const String &varName)
+const Variant& InputNode::GetCurrentValue(StringHash varId)
 {
-    if ( varName == variableName_  && connectedOutputNode_)
+    if ( varId == variableHash_  && connectedOutputNode_)
     {
-        return connectedOutputNode_->GetCurrentValue(connectedOutputVarName_);
+        return connectedOutputNode_->GetCurrentValue(connectedOutputVarHash_);
     }
 
     return Variant::EMPTY;
@@ -50,16 +50,28 @@ public:
     OutputNode* GetConnectedOutputNode() { return connectedOutputNode_; }
 
     // related to timevar input
-    virtual float GetValueRangeMin(const String &varName);
-    virtual float GetValueRangeMax(const String &varName);
-    virtual float GetStartTime(const String &varName);
-    virtual float GetEndTime(const String &varName);
-    virtual float GetValueAtTime(const String &varName, float time);
+    virtual float GetValueRangeMin(StringHash varId);
+    virtual float GetValueRangeMax(StringHash varId);
+    virtual float GetStartTime(StringHash varId);
+    virtual float GetEndTime(StringHash varId);
+    virtual float GetValueAtTime(StringHash varId, float time);
+    virtual void GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n);
 
     // related to slidevar input
-    virtual const Variant& GetRangeMin(const String &varName);
-    virtual const Variant& GetRangeMax(const String &varName);
-    virtual const Variant& GetCurrentValue(const String &varName);
+    virtual const Variant& GetRangeMin(StringHash varId);
+    virtual const Variant& GetRangeMax(StringHash varId);
+    virtual const Variant& GetCurrentValue(StringHash varId);
+
+    // keep the string keyed wrappers visible
+    using IOElement::GetValueRangeMin;
+    using IOElement::GetValueRangeMax;
+    using IOElement::GetStartTime;
+    using IOElement::GetEndTime;
+    using IOElement::GetValueAtTime;
+    using IOElement::GetValuesAtTimes;
+    using IOElement::GetRangeMin;
+    using IOElement::GetRangeMax;
+    using IOElement::GetCurrentValue;
 
 protected:
     bool InitInternal();
@@ -71,9 +83,11 @@ protected:
     void HandleLayoutUpdated(StringHash eventType, VariantMap& eventData);
     void SendReceiverMovedEvent();
 
+    friend class OutputNode;
+
 protected:
     WeakPtr<OutputNode> connectedOutputNode_;
-    String              connectedOutputVarName_;
+    StringHash          connectedOutputVarHash_;
 
     WeakPtr<InputBox>   inputBox_;
     IntVector2          controlBoxSize_;
@@ -46,6 +46,8 @@ void InputNodeManager::RegisterObject(Context* context)
 
 InputNodeManager::InputNodeManager(Context *context)
     : Object(context)
+    , connectionVersion_(1)
+    , dataVersion_(0)
 {
 }
 
@@ -37,8 +37,17 @@ public:
     bool Remove(InputBox *inputBox);
     bool GetNodesInside(Vector<InputBox*> &result, const Vector2 &pos, const Vector2 &size);
 
+    // changes whenever a connection is made, broken or an io element goes away
+    void BumpConnectionVersion()            { connectionVersion_++; }
+    unsigned GetConnectionVersion() const   { return connectionVersion_; }
+
+    // source of IOElement data versions
+    unsigned NextDataVersion()              { return ++dataVersion_; }
+
 protected:
 	Vector<InputBox*> inputBoxList_;
+	unsigned          connectionVersion_;
+	unsigned          dataVersion_;
 };
 
 
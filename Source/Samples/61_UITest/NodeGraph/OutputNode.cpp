@@ -35,6 +35,7 @@
 #include "OutputNode.h"
 #include "PageManager.h"
 #include "InputNodeManager.h"
+#include "GraphNodeRegistry.h"
 
 #include <Urho3D/DebugNew.h>
 
@@ -60,9 +61,29 @@ void OutputNode::RegisterObject(Context* context)
 OutputNode::OutputNode(Context *context)
     : IOElement(context)
     , showOutputLine_(true)
+    , cacheEpoch_(1)
+    , cacheQueried_(false)
 {
     SetIOType(IOTYPE_OUTPUT);
     SetColor(GraphNode::GetDefaultBodyColor());
+
+    // epoch 0 is never current, everything starts out empty
+    for ( unsigned i = 0; i < MAX_CACHED_FLOATS; ++i )
+    {
+        floatEpochs_[i] = 0;
+        cachedFloats_[i] = 0.0f;
+    }
+
+    for ( unsigned i = 0; i < MAX_CACHED_VARIANTS; ++i )
+    {
+        variantEpochs_[i] = 0;
+    }
+
+    for ( unsigned i = 0; i < OUTPUT_TIME_CACHE_SIZE; ++i )
+    {
+        timeCache_[i].key_ = 0;
+        timeCache_[i].value_ = 0.0f;
+    }
 }
 
 OutputNode::~OutputNode()
@@ -97,8 +118,7 @@ bool OutputNode::Create(const String &variableName, const IntVector2 &size)
 
 bool OutputNode::CreateLineBatcher(LineType linetype, const Color& color, float pixelSize)
 {
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-    Texture2D *tex2d = cache->GetResource<Texture2D>("Textures/UI.png");
+    Texture2D *tex2d = GetSubsystem<GraphNodeRegistry>()->GetUITexture();
     IntRect rect = LineBatcher::GetBoxRect();
     PageManager* ui = GetSubsystem<PageManager>();
     UIElement* root = ui->GetRoot();
@@ -237,6 +257,50 @@ void OutputNode::HandleButtonDragEnd(StringHash eventType, VariantMap& eventData
     }
 }
 
+void OutputNode::PropagateDataChanged(unsigned version)
+{
+    if ( GetDataVersion() == version )
+        return;
+
+    cacheEpoch_++;
+
+    IOElement::PropagateDataChanged(version);
+
+    if ( connectedInputNode_ )
+    {
+        connectedInputNode_->PropagateDataChanged(version);
+    }
+}
+
+void OutputNode::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    cacheEpoch_++;
+
+    // nobody asked during the last frame. the bump above makes the next
+    // query a miss, which subscribes again
+    if ( !cacheQueried_ )
+    {
+        UnsubscribeFromEvent(E_BEGINFRAME);
+    }
+
+    cacheQueried_ = false;
+}
+
+void OutputNode::NoteCacheMiss()
+{
+    // the first query of a frame always misses, so only misses need to mark
+    // the port as in use
+    if ( !cacheQueried_ )
+    {
+        cacheQueried_ = true;
+
+        if ( !HasSubscribedToEvent(E_BEGINFRAME) )
+        {
+            SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(OutputNode, HandleBeginFrame));
+        }
+    }
+}
+
 bool OutputNode::AttemptConnect(InputNode *inputNode)
 {
     if ( inputNode )
@@ -343,45 +407,136 @@ void OutputNode::CalculateInnerPoints()
 }
 
 // related to timevar input
-float OutputNode::GetValueRangeMin(const String &varName)
+float OutputNode::GetValueRangeMin(StringHash varId)
 {
-    return GetNodeBasePtr()->GetValueRangeMin(varName);
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetValueRangeMin(varId);
+
+    if ( floatEpochs_[CACHE_VALUERANGEMIN] != cacheEpoch_ )
+    {
+        NoteCacheMiss();
+        cachedFloats_[CACHE_VALUERANGEMIN] = GetNodeBasePtr()->GetValueRangeMin(varId);
+        floatEpochs_[CACHE_VALUERANGEMIN] = cacheEpoch_;
+    }
+
+    return cachedFloats_[CACHE_VALUERANGEMIN];
 }
 
-float OutputNode::GetValueRangeMax(const String &varName)
+float OutputNode::GetValueRangeMax(StringHash varId)
 {
-    return GetNodeBasePtr()->GetValueRangeMax(varName);
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetValueRangeMax(varId);
+
+    if ( floatEpochs_[CACHE_VALUERANGEMAX] != cacheEpoch_ )
+    {
+        NoteCacheMiss();
+        cachedFloats_[CACHE_VALUERANGEMAX] = GetNodeBasePtr()->GetValueRangeMax(varId);
+        floatEpochs_[CACHE_VALUERANGEMAX] = cacheEpoch_;
+    }
+
+    return cachedFloats_[CACHE_VALUERANGEMAX];
 }
 
-float OutputNode::GetStartTime(const String &varName)
+float OutputNode::GetStartTime(StringHash varId)
 {
-    return GetNodeBasePtr()->GetStartTime(varName);
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetStartTime(varId);
+
+    if ( floatEpochs_[CACHE_STARTTIME] != cacheEpoch_ )
+    {
+        NoteCacheMiss();
+        cachedFloats_[CACHE_STARTTIME] = GetNodeBasePtr()->GetStartTime(varId);
+        floatEpochs_[CACHE_STARTTIME] = cacheEpoch_;
+    }
+
+    return cachedFloats_[CACHE_STARTTIME];
 }
 
-float OutputNode::GetEndTime(const String &varName)
+float OutputNode::GetEndTime(StringHash varId)
 {
-    return GetNodeBasePtr()->GetEndTime(varName);
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetEndTime(varId);
+
+    if ( floatEpochs_[CACHE_ENDTIME] != cacheEpoch_ )
+    {
+        NoteCacheMiss();
+        cachedFloats_[CACHE_ENDTIME] = GetNodeBasePtr()->GetEndTime(varId);
+        floatEpochs_[CACHE_ENDTIME] = cacheEpoch_;
+    }
+
+    return cachedFloats_[CACHE_ENDTIME];
 }
 
-float OutputNode::GetValueAtTime(const String &varName, float time)
+float OutputNode::GetValueAtTime(StringHash varId, float time)
 {
-    return GetNodeBasePtr()->GetValueAtTime(varName, time);
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetValueAtTime(varId, time);
+
+    unsigned bits;
+    memcpy(&bits, &time, sizeof(bits));
+
+    unsigned long long key = ((unsigned long long)cacheEpoch_ << 32) | bits;
+    TimeCacheEntry &entry = timeCache_[(bits * 2654435761u) >> (32 - OUTPUT_TIME_CACHE_BITS)];
+
+    if ( entry.key_ != key )
+    {
+        NoteCacheMiss();
+        entry.value_ = GetNodeBasePtr()->GetValueAtTime(varId, time);
+        entry.key_ = key;
+    }
+
+    return entry.value_;
 }
 
-// related to slidevar input
-const Variant& OutputNode::GetRangeMin(const String &varName)
+void OutputNode::GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n)
 {
-    return GetNodeBasePtr()->GetRangeMin(varName);
+    // batches rarely repeat, they go straight through
+    GetNodeBasePtr()->GetValuesAtTimes(varId, times, out, n);
 }
 
-const Variant& OutputNode::GetRangeMax(const String &varName)
+// related to slidevar input
+const Variant& OutputNode::GetRangeMin(StringHash varId)
 {
-    return GetNodeBasePtr()->GetRangeMax(varName);
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetRangeMin(varId);
+
+    if ( variantEpochs_[CACHE_RANGEMIN] != cacheEpoch_ )
+    {
+        NoteCacheMiss();
+        cachedVariants_[CACHE_RANGEMIN] = GetNodeBasePtr()->GetRangeMin(varId);
+        variantEpochs_[CACHE_RANGEMIN] = cacheEpoch_;
+    }
+
+    return cachedVariants_[CACHE_RANGEMIN];
 }
 
-const Variant& OutputNode::GetCurrentValue(const String &varName)
+const Variant& OutputNode::GetRangeMax(StringHash varId)
 {
-    return GetNodeBasePtr()->GetCurrentValue(varName);
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetRangeMax(varId);
+
+    if ( variantEpochs_[CACHE_RANGEMAX] != cacheEpoch_ )
+    {
+        NoteCacheMiss();
+        cachedVariants_[CACHE_RANGEMAX] = GetNodeBasePtr()->GetRangeMax(varId);
+        variantEpochs_[CACHE_RANGEMAX] = cacheEpoch_;
+    }
+
+    return cachedVariants_[CACHE_RANGEMAX];
 }
 
+const Variant& OutputNode::GetCurrentValue(StringHash varId)
+{
+    if ( varId != variableHash_ )
+        return GetNodeBasePtr()->GetCurrentValue(varId);
+
+    if ( variantEpochs_[CACHE_CURRENTVALUE] != cacheEpoch_ )
+    {
+        NoteCacheMiss();
+        cachedVariants_[CACHE_CURRENTVALUE] = GetNodeBasePtr()->GetCurrentValue(varId);
+        variantEpochs_[CACHE_CURRENTVALUE] = cacheEpoch_;
+    }
+
+    return cachedVariants_[CACHE_CURRENTVALUE];
+}
 
@@ -23,6 +23,11 @@
 #include "InputNode.h"
 
 class OutputBox;
+//=============================================================================
+//=============================================================================
+#define OUTPUT_TIME_CACHE_BITS  4
+#define OUTPUT_TIME_CACHE_SIZE  (1 << OUTPUT_TIME_CACHE_BITS)
+
 //=============================================================================
 //=============================================================================
 class OutputNode : public IOElement
@@ -41,20 +46,35 @@ public:
     void SetEnableCtrlButton(bool enable) { ctrlButton_->SetEnabled(enable); }
 
     // related to timevar input
-    virtual float GetValueRangeMin(const String &varName);
-    virtual float GetValueRangeMax(const String &varName);
-    virtual float GetStartTime(const String &varName);
-    virtual float GetEndTime(const String &varName);
-    virtual float GetValueAtTime(const String &varName, float time);
+    virtual float GetValueRangeMin(StringHash varId);
+    virtual float GetValueRangeMax(StringHash varId);
+    virtual float GetStartTime(StringHash varId);
+    virtual float GetEndTime(StringHash varId);
+    virtual float GetValueAtTime(StringHash varId, float time);
+    virtual void GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n);
 
     // related to slidevar input
-    virtual const Variant& GetRangeMin(const String &varName);
-    virtual const Variant& GetRangeMax(const String &varName);
-    virtual const Variant& GetCurrentValue(const String &varName);
+    virtual const Variant& GetRangeMin(StringHash varId);
+    virtual const Variant& GetRangeMax(StringHash varId);
+    virtual const Variant& GetCurrentValue(StringHash varId);
+
+    // keep the string keyed wrappers visible
+    using IOElement::GetValueRangeMin;
+    using IOElement::GetValueRangeMax;
+    using IOElement::GetStartTime;
+    using IOElement::GetEndTime;
+    using IOElement::GetValueAtTime;
+    using IOElement::GetValuesAtTimes;
+    using IOElement::GetRangeMin;
+    using IOElement::GetRangeMax;
+    using IOElement::GetCurrentValue;
 
 protected:
     bool InitInternal();
     bool CreateLineBatcher(LineType linetype, const Color& color, float pixelSize);
+    virtual void PropagateDataChanged(unsigned version);
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void NoteCacheMiss();
 
     void HandleBaseDragMove(StringHash eventType, VariantMap& eventData);
 
@@ -82,6 +102,43 @@ protected:
     float                 pixelSize_;
     bool                  showOutputLine_;
 
+    // answers for this port's own variable. an entry is valid while its epoch
+    // matches cacheEpoch_, which moves on every edit pushed to the port and
+    // on every frame while the port is being queried, so a hit is a single
+    // compare. a port nobody queries doesn't listen for frames. an element
+    // removed further upstream is picked up at the next frame
+    enum CachedFloatType
+    {
+        CACHE_VALUERANGEMIN,
+        CACHE_VALUERANGEMAX,
+        CACHE_STARTTIME,
+        CACHE_ENDTIME,
+        MAX_CACHED_FLOATS
+    };
+
+    enum CachedVariantType
+    {
+        CACHE_RANGEMIN,
+        CACHE_RANGEMAX,
+        CACHE_CURRENTVALUE,
+        MAX_CACHED_VARIANTS
+    };
+
+    // direct mapped on the time bits, the key is epoch << 32 | time bits
+    struct TimeCacheEntry
+    {
+        unsigned long long key_;
+        float              value_;
+    };
+
+    unsigned              cacheEpoch_;
+    bool                  cacheQueried_;
+    unsigned              floatEpochs_[MAX_CACHED_FLOATS];
+    float                 cachedFloats_[MAX_CACHED_FLOATS];
+    unsigned              variantEpochs_[MAX_CACHED_VARIANTS];
+    Variant               cachedVariants_[MAX_CACHED_VARIANTS];
+    TimeCacheEntry        timeCache_[OUTPUT_TIME_CACHE_SIZE];
+
 protected:
     enum PointSizeType{ MAX_POINTS = 5 };
 };
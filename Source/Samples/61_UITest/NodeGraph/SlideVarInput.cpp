@@ -104,6 +104,8 @@ void SlideVarInput::SetRange(const Variant &vmin, const Variant &vmax)
 
     varMin_ = vmin;
     varMax_ = vmax;
+
+    MarkDataChanged();
 }
 
 void SlideVarInput::SetCurrentValue(const Variant &val)
@@ -125,6 +127,8 @@ void SlideVarInput::SetCurrentValue(const Variant &val)
     default:
         assert(false && "only INT and FLOAT are implemented, implement what you need");
     }
+
+    MarkDataChanged();
 }
 
 void SlideVarInput::SetVarChangedCallback(UIElement *process, VarChangedCallback callback)
@@ -135,6 +139,8 @@ void SlideVarInput::SetVarChangedCallback(UIElement *process, VarChangedCallback
 
 void SlideVarInput::ValueUpdate(float delta)
 {
+    Variant prevValue = varCurrentValue_;
+
     if (varMax_.GetType() == VAR_INT)
     {
         currentValue_ += delta * sensitivity_;
@@ -150,6 +156,12 @@ void SlideVarInput::ValueUpdate(float delta)
         variableText_->SetText( String(varCurrentValue_.GetFloat()) );
     }
 
+    // a drag against the range limits changes nothing downstream
+    if (varCurrentValue_ != prevValue)
+    {
+        MarkDataChanged();
+    }
+
     // listener callback
     if (processCaller && pfnVarChangedCallback)
     {
@@ -173,27 +185,27 @@ void SlideVarInput::OnDragMove(const IntVector2& position, const IntVector2& scr
 
 //===============================================
 // related to slidevar input
-const Variant& SlideVarInput::GetRangeMin(const String &varName)
+const Variant& SlideVarInput::GetRangeMin(StringHash varId)
 {
-    if ( varName == variableName_ )
+    if ( varId == variableHash_ )
     {
         return varMin_;
     }
     return Variant::EMPTY;
 }
 
-const Variant& SlideVarInput::GetRangeMax(const String &varName)
+const Variant& SlideVarInput::GetRangeMax(StringHash varId)
 {
-    if ( varName == variableName_ )
+    if ( varId == variableHash_ )
     {
         return varMax_;
     }
     return Variant::EMPTY;
 }
 
-const Variant& SlideVarInput::GetCurrentValue(const String &varName)
+const Variant& SlideVarInput::GetCurrentValue(StringHash varId)
 {
-    if ( varName == variableName_ )
+    if ( varId == variableHash_ )
     {
         return varCurrentValue_;
     }
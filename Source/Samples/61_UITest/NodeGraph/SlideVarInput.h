@@ -61,11 +61,17 @@ public:
     void SetVarChangedCallback(UIElement *process, VarChangedCallback callback);
 
     const Variant& GetCurrentValue() { return varCurrentValue_; }
+    const Variant& GetRangeMin()     { return varMin_; }
+    const Variant& GetRangeMax()     { return varMax_; }
 
     // related to slidevar input
-    virtual const Variant& GetRangeMin(const String &varName);
-    virtual const Variant& GetRangeMax(const String &varName);
-    virtual const Variant& GetCurrentValue(const String &varName);
+    virtual const Variant& GetRangeMin(StringHash varId);
+    virtual const Variant& GetRangeMax(StringHash varId);
+    virtual const Variant& GetCurrentValue(StringHash varId);
+
+    using IOElement::GetRangeMin;
+    using IOElement::GetRangeMax;
+    using IOElement::GetCurrentValue;
 
 protected:
     bool InitInternal();
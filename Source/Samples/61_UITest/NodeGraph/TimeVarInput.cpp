@@ -21,6 +21,9 @@
 //
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/Log.h>
 #include <Urho3D/UI/UIEvents.h>
 #include <Urho3D/UI/Button.h>
 #include <Urho3D/UI/BorderImage.h>
@@ -31,6 +34,10 @@
 #include <Urho3D/Graphics/Texture2D.h>
 
 #include <stdio.h>
+#include <string.h>
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
 
 #include "TimeVarInput.h"
 #include "PageManager.h"
@@ -43,6 +50,223 @@
 #define CTRL_BUTTON_SIZE     10
 #define BUTTON_SPACING       CTRL_BUTTON_SIZE*2
 #define DEFAULT_LINE_SIZE    2.0f
+#define PIXELS_PER_LINE_STEP 4
+#define MIN_TIME_RANGE       0.1f
+#define MIN_VALUE_RANGE      1.0f
+
+static const Color channelColors[MAX_CURVE_CHANNELS] = { Color::RED, Color::GREEN, Color::CYAN, Color::WHITE };
+//=============================================================================
+//=============================================================================
+void CurveSpans::Clear()
+{
+    knotTimes_.Clear();
+    invLengths_.Clear();
+    coeffs_.Clear();
+    numSpans_ = 0;
+    numChannels_ = 1;
+    channelStride_ = 1;
+}
+
+bool CurveSpans::Build(const PODVector<Vector2> &keyframes)
+{
+    PODVector<float> times(keyframes.Size());
+    PODVector<float> values(keyframes.Size());
+
+    for ( unsigned i = 0; i < keyframes.Size(); ++i )
+    {
+        times[i] = keyframes[i].x_;
+        values[i] = keyframes[i].y_;
+    }
+
+    return Build(times, values, 1);
+}
+
+bool CurveSpans::Build(const PODVector<float> &times, const PODVector<float> &values, unsigned numChannels)
+{
+    unsigned numKeys = times.Size();
+
+    if ( numKeys < 2 || numChannels == 0 || numChannels > MAX_CURVE_CHANNELS || values.Size() != numKeys * numChannels )
+        return false;
+
+    // rejected before anything is touched, the previous spans stay valid
+    for ( unsigned i = 1; i < numKeys; ++i )
+    {
+        if ( !(times[i] > times[i - 1]) )
+            return false;
+    }
+
+    Clear();
+
+    // tangents in value per time, an end knot is duplicated one span out
+    // (same end condition as Spline's CATMULL_ROM_FULL_CURVE)
+    PODVector<float> slopes(numKeys * numChannels);
+
+    for ( unsigned i = 0; i < numKeys; ++i )
+    {
+        unsigned prev = i > 0 ? i - 1 : 0;
+        unsigned next = i + 1 < numKeys ? i + 1 : numKeys - 1;
+        float dt = times[next] - times[prev];
+
+        if ( i == 0 || i == numKeys - 1 )
+            dt *= 2.0f;
+
+        for ( unsigned ch = 0; ch < numChannels; ++ch )
+        {
+            float dv = values[next * numChannels + ch] - values[prev * numChannels + ch];
+            slopes[i * numChannels + ch] = dt > 0.0f ? dv / dt : 0.0f;
+        }
+    }
+
+    // several channels are padded to a full register
+    numSpans_ = numKeys - 1;
+    numChannels_ = numChannels;
+    channelStride_ = numChannels > 1 ? MAX_CURVE_CHANNELS : 1;
+    knotTimes_ = times;
+    invLengths_.Resize(numSpans_);
+    coeffs_.Resize(numSpans_ * 4 * channelStride_);
+
+    for ( unsigned i = 0; i < coeffs_.Size(); ++i )
+    {
+        coeffs_[i] = 0.0f;
+    }
+
+    for ( unsigned i = 0; i < numSpans_; ++i )
+    {
+        float h = times[i + 1] - times[i];
+        float *c = &coeffs_[i * 4 * channelStride_];
+
+        // hermite form with the tangents scaled to the span
+        for ( unsigned ch = 0; ch < numChannels; ++ch )
+        {
+            float p1 = values[i * numChannels + ch];
+            float p2 = values[(i + 1) * numChannels + ch];
+            float m1 = slopes[i * numChannels + ch] * h;
+            float m2 = slopes[(i + 1) * numChannels + ch] * h;
+
+            c[ch]                      = 2.0f * (p1 - p2) + m1 + m2;
+            c[channelStride_ + ch]     = 3.0f * (p2 - p1) - 2.0f * m1 - m2;
+            c[2 * channelStride_ + ch] = m1;
+            c[3 * channelStride_ + ch] = p1;
+        }
+
+        invLengths_[i] = 1.0f / h;
+    }
+
+    return true;
+}
+
+unsigned CurveSpans::FindSpan(float time, unsigned hint) const
+{
+    if ( hint < numSpans_ && time >= knotTimes_[hint] )
+    {
+        if ( hint + 1 == numSpans_ || time < knotTimes_[hint + 1] )
+            return hint;
+
+        if ( hint + 2 == numSpans_ || time < knotTimes_[hint + 2] )
+            return hint + 1;
+    }
+
+    // last knot at or before the time
+    unsigned lo = 0;
+    unsigned hi = numSpans_ - 1;
+
+    while ( lo < hi )
+    {
+        unsigned mid = (lo + hi + 1) >> 1;
+
+        if ( knotTimes_[mid] <= time )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+float CurveSpans::GetSpanParam(float time, unsigned &span) const
+{
+    float t = Clamp(time, knotTimes_.Front(), knotTimes_.Back());
+
+    span = FindSpan(t, span);
+
+    return (t - knotTimes_[span]) * invLengths_[span];
+}
+
+float CurveSpans::Evaluate(float time, unsigned &span) const
+{
+    if ( numSpans_ == 0 )
+        return 0.0f;
+
+    float f = GetSpanParam(time, span);
+    const float *c = GetSpanCoeffs(span);
+    unsigned s = channelStride_;
+
+    return ((c[0] * f + c[s]) * f + c[2 * s]) * f + c[3 * s];
+}
+
+float CurveSpans::Evaluate(float time) const
+{
+    unsigned span = M_MAX_UNSIGNED;
+
+    return Evaluate(time, span);
+}
+
+void CurveSpans::EvaluateChannels(float time, unsigned &span, float *out) const
+{
+    if ( numSpans_ == 0 )
+    {
+        for ( unsigned ch = 0; ch < numChannels_; ++ch )
+            out[ch] = 0.0f;
+        return;
+    }
+
+    float f = GetSpanParam(time, span);
+    const float *c = GetSpanCoeffs(span);
+    unsigned s = channelStride_;
+
+#ifdef URHO3D_SSE
+    if ( s == MAX_CURVE_CHANNELS )
+    {
+        float lanes[MAX_CURVE_CHANNELS];
+        __m128 vf = _mm_set1_ps(f);
+        __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c), vf), _mm_loadu_ps(c + 4));
+        v = _mm_add_ps(_mm_mul_ps(v, vf), _mm_loadu_ps(c + 8));
+        v = _mm_add_ps(_mm_mul_ps(v, vf), _mm_loadu_ps(c + 12));
+        _mm_storeu_ps(lanes, v);
+
+        for ( unsigned ch = 0; ch < numChannels_; ++ch )
+            out[ch] = lanes[ch];
+        return;
+    }
+#endif
+
+    for ( unsigned ch = 0; ch < numChannels_; ++ch )
+    {
+        out[ch] = ((c[ch] * f + c[s + ch]) * f + c[2 * s + ch]) * f + c[3 * s + ch];
+    }
+}
+
+float CurveSpans::GetMaxSecondDerivative(unsigned channel) const
+{
+    // v'' is linear within a span, so its max is at one of the ends
+    float maxSecond = 0.0f;
+
+    if ( channel >= numChannels_ )
+        return maxSecond;
+
+    for ( unsigned i = 0; i < numSpans_; ++i )
+    {
+        const float *c = GetSpanCoeffs(i);
+        float a = c[channel];
+        float b = c[channelStride_ + channel];
+        float d2 = Max(Abs(2.0f * b), Abs(6.0f * a + 2.0f * b));
+
+        maxSecond = Max(maxSecond, d2 * invLengths_[i] * invLengths_[i]);
+    }
+
+    return maxSecond;
+}
+
 //=============================================================================
 //=============================================================================
 void TimeVarInput::RegisterObject(Context* context)
@@ -58,13 +282,34 @@ TimeVarInput::TimeVarInput(Context *context)
     , timeStart_(0.0f)
     , timeEnd_(1.0f)
     , timeRange_(1.0f)
+    , numChannels_(1)
+    , lastSpan_(0)
+    , lutScale_(0.0f)
+    , bakedErrorBound_(0.0f)
+    , lutResolution_(DEFAULT_CURVE_LUT_SIZE)
+    , curveSerial_(0)
+    , bakedMode_(false)
+    , bakedValid_(false)
+    , bakePending_(false)
+    , fitError_(0.0f)
 {
     SetIOType(IOTYPE_INPUT);
-    spline_.SetInterpolationMode(CATMULL_ROM_FULL_CURVE);
 }
 
 TimeVarInput::~TimeVarInput()
 {
+    // the workers hold raw pointers to the jobs, they can't outlive us
+    WorkQueue *queue = GetSubsystem<WorkQueue>();
+    SharedPtr<WorkItem> items[2] = { bakeItem_, fitItem_ };
+
+    for ( unsigned i = 0; i < 2; ++i )
+    {
+        if ( items[i] && (queue == NULL || !queue->RemoveWorkItem(items[i])) )
+        {
+            while ( !items[i]->completed_ )
+                Time::Sleep(0);
+        }
+    }
 }
 
 bool TimeVarInput::InitInternal()
@@ -98,32 +343,20 @@ bool TimeVarInput::InitScreen(const IntVector2 &size)
     // fix size
     SetFixedSize(size);
 
-    IntVector2 absPos = GetScreenPosition();
-    IntVector2 scrnSize = size;
-    int horizSpacing = scrnSize.x_/4;
     controlBoxSize_ = IntVector2(CTRL_BUTTON_SIZE, CTRL_BUTTON_SIZE);
 
-    IntVector2 points[MAX_POINTS] =
-    {
-        { controlBoxSize_.x_/2, scrnSize.y_/2 },
-        { horizSpacing * 1, scrnSize.y_/2 },
-        { horizSpacing * 2, scrnSize.y_/2 },
-        { horizSpacing * 3, scrnSize.y_/2 },
-        { horizSpacing * 4 - controlBoxSize_.x_/2, scrnSize.y_/2 },
-    };
-
-    pointList_.Resize(MAX_POINTS);
-    absolutePositionList_.Resize(MAX_POINTS);
-    spline_.Clear();
+    // flat curve across the default ranges
+    keyTimes_.Resize(DEFAULT_NUM_KEYFRAMES);
+    keyValues_.Resize(DEFAULT_NUM_KEYFRAMES);
 
-    for ( int i = 0; i < MAX_POINTS; ++i )
+    for ( unsigned i = 0; i < keyTimes_.Size(); ++i )
     {
-        pointList_[i] = points[i];
-        absolutePositionList_[i] = points[i] + absPos;
-        Variant var = Vector2((float)pointList_[i].x_, (float)pointList_[i].y_);
-        spline_.AddKnot(var);
+        keyTimes_[i] = timeStart_ + timeRange_ * (float)i / (float)(DEFAULT_NUM_KEYFRAMES - 1);
+        keyValues_[i] = minValue_ + valueRange_ * 0.5f;
     }
 
+    UpdateCurve();
+
     // text
     int textsize = (size.x_ > 400)?8:6;
     textTitle_     = CreateText(textsize, IntVector2(size.x_/2, 5) );
@@ -132,10 +365,6 @@ bool TimeVarInput::InitScreen(const IntVector2 &size)
     textTimeStart_ = CreateText(textsize, IntVector2(20, size.y_ - 15) );
     textTimeEnd_   = CreateText(textsize, IntVector2(size.x_ - 40, size.y_ - 15) );
 
-    // sub
-    SubscribeToEvent(GetNodeBasePtr(), E_BASE_DRAGMOVE, URHO3D_HANDLER(TimeVarInput, HandleBaseDragMove));
-    SubscribeToEvent(GetNodeBasePtr(), E_LAYOUTUPDATED, URHO3D_HANDLER(TimeVarInput, HandleLayoutUpdated));
-
     return true;
 }
 Text* TimeVarInput::CreateText(int size, const IntVector2 &pos)
@@ -157,26 +386,42 @@ bool TimeVarInput::CreateLineBatcher(LineType linetype, const Color& color, floa
     IntRect rect = LineBatcher::GetBoxRect();
 
     pixelSize_ = pixelSize;
+    linetype_ = linetype;
 
-    lineBatcher_ = CreateChild<LineBatcher>();
-    lineBatcher_->SetLineTexture(uiTex2d);
-    lineBatcher_->SetLineRect(rect);
-    lineBatcher_->SetLineType(linetype);
-    lineBatcher_->SetLinePixelSize(pixelSize_);
-    lineBatcher_->SetColor(color);
-    lineBatcher_->SetNumPointsPerSegment(NUM_PTS_PER_CURVE_SEGMENT);
-    lineBatcher_->SetPriority(-1);
-    lineBatcher_->SetBringToBack(true);
+    // channel 0 takes the given color, the others come from channelColors
+    for ( unsigned ch = 0; ch < MAX_CURVE_CHANNELS; ++ch )
+    {
+        LineBatcher *lineBatcher = CreateChild<LineBatcher>();
+        lineBatcher->SetLineTexture(uiTex2d);
+        lineBatcher->SetLineRect(rect);
+        lineBatcher->SetLineType(linetype);
+        lineBatcher->SetLinePixelSize(pixelSize_);
+        lineBatcher->SetColor(ch == 0 ? color : channelColors[ch]);
+        lineBatcher->SetNumPointsPerSegment(NUM_PTS_PER_CURVE_SEGMENT);
+        lineBatcher->SetPriority(-1);
+        lineBatcher->SetBringToBack(true);
+
+        lineBatchers_.Push(WeakPtr<LineBatcher>(lineBatcher));
+    }
 
-    lineBatcher_->DrawPoints(absolutePositionList_);
+    UpdateChannelLines();
+    RedrawCurve();
 
     return true;
 }
 
+void TimeVarInput::UpdateChannelLines()
+{
+    for ( unsigned ch = 0; ch < lineBatchers_.Size(); ++ch )
+    {
+        lineBatchers_[ch]->SetVisible(ch < numChannels_);
+    }
+}
+
 bool TimeVarInput::CreateButtons()
 {
     // init line prior to calling this fn
-    if (lineBatcher_ == NULL)
+    if (lineBatchers_.Empty())
     {
         return false;
     }
@@ -188,12 +433,21 @@ bool TimeVarInput::CreateButtons()
     IntRect rect = LineBatcher::GetBoxRect();
     IntVector2 boxsize = LineBatcher::GetBoxSize();
 
-    for ( int i = 0; i < (int)pointList_.Size(); ++i )
+    for ( unsigned i = 0; i < buttonList_.Size(); ++i )
+    {
+        UnsubscribeFromEvent(buttonList_[i], E_DRAGMOVE);
+        buttonList_[i]->Remove();
+    }
+    buttonList_.Clear();
+
+    for ( unsigned i = 0; i < keyValues_.Size(); ++i )
     {
+        unsigned key = i / numChannels_;
+
         Button *button = CreateChild<Button>();
         button->SetTexture(uiTex2d);
         button->SetImageRect(rect);
-        button->SetPosition(pointList_[i] - controlBoxSize_/2);
+        button->SetPosition(KeyframeToButtonPos(Vector2(keyTimes_[key], keyValues_[i])));
         button->SetSize(controlBoxSize_);
         button->SetVisible(true);
         button->SetColor(Color(1,1,0));
@@ -208,91 +462,136 @@ bool TimeVarInput::CreateButtons()
 
 bool TimeVarInput::InitDataCurvePoints(const PODVector<Vector2> &points)
 {
-    if ( points.Size() != MAX_POINTS )
+    PODVector<float> times(points.Size());
+    PODVector<float> values(points.Size());
+
+    for ( unsigned i = 0; i < points.Size(); ++i )
+    {
+        times[i] = points[i].x_;
+        values[i] = points[i].y_;
+    }
+
+    return InitDataCurveChannels(times, values, 1);
+}
+
+bool TimeVarInput::InitDataCurveChannels(const PODVector<float> &times, const PODVector<float> &values, unsigned numChannels)
+{
+    if ( times.Size() < 2 || numChannels == 0 || numChannels > MAX_CURVE_CHANNELS )
     {
         return false;
     }
 
-    // eval curve points and normalize (scaled to range)
-    IntVector2 scrnSize = GetSize() - controlBoxSize_;
-    PODVector<IntVector2> scrnPoints;
+    if ( values.Size() != times.Size() * numChannels )
+    {
+        return false;
+    }
 
-    EvaluateCurvePoints(points, scrnPoints);
+    // written to fail on nan as well
+    if ( !(times.Front() >= 0.0f) || times.Back() >= M_INFINITY )
+    {
+        return false;
+    }
 
-    for ( int i = 0; i < MAX_POINTS; ++i )
+    for ( unsigned i = 1; i < times.Size(); ++i )
     {
-        IntVector2 btnPos = scrnPoints[ i ];
-        //btnPos.y_ = scrnSize.y_ - btnPos.y_;
+        if ( !(times[i] > times[i - 1]) )
+            return false;
+    }
 
-        btnPos.x_ = ( btnPos.x_ < 0)?0:(btnPos.x_ > scrnSize.x_)?scrnSize.x_:btnPos.x_;
-        btnPos.y_ = ( btnPos.y_ < 0)?0:(btnPos.y_ > scrnSize.y_)?scrnSize.y_:btnPos.y_;
+    // keep the data as given, only the buttons are snapped to pixels
+    if ( !EvaluateCurveRanges(times, values) )
+    {
+        return false;
+    }
 
-        if (i == 0)
-        {
-            btnPos.x_ = 0;
-        }
-        else if (i == buttonList_.Size() - 1)
-        {
-            btnPos.x_ = scrnSize.x_;
-        }
-        else
-        {
-            if (btnPos.x_ < buttonList_[i-1]->GetPosition().x_ + BUTTON_SPACING )
-            {
-                btnPos.x_ = buttonList_[i-1]->GetPosition().x_ + BUTTON_SPACING;
-            }
+    keyTimes_ = times;
+    keyValues_ = values;
+    numChannels_ = numChannels;
 
-            if (btnPos.x_ > buttonList_[i+1]->GetPosition().x_ - BUTTON_SPACING)
-            {
-                btnPos.x_ = buttonList_[i+1]->GetPosition().x_ - BUTTON_SPACING;
-            }
-        }
+    if ( !UpdateCurve() )
+        return false;
 
-        buttonList_[i]->SetPosition(btnPos);
-        pointList_[i] = btnPos;
-    }
+    UpdateChannelLines();
+
+    if ( buttonList_.Size() == keyValues_.Size() )
+        UpdateButtons();
+    else
+        CreateButtons();
 
-    // updat draw line
-    UpdateDrawLine();
+    RedrawCurve();
 
     return true;
 }
 
-void TimeVarInput::EvaluateCurvePoints(const PODVector<Vector2> &points, PODVector<IntVector2> &outPoints)
+bool TimeVarInput::EvaluateCurveRanges(const PODVector<float> &times, const PODVector<float> &values)
 {
     float rmin=1e19f;
     float rmax=-1e19f;
-    float tmin=1e19f;
-    float tmax=-1e19f;
 
-    for ( unsigned i = 0; i < points.Size(); ++i )
+    // the channels share one value range
+    for ( unsigned i = 0; i < values.Size(); ++i )
     {
-        assert(points[i].x_ >= 0.0f && "time value must be positive");
+        if ( IsNaN(values[i]) )
+            return false;
+
+        if (values[i] < rmin) rmin = values[i];
+        if (values[i] > rmax) rmax = values[i];
+    }
 
-        if (points[i].x_ < tmin) tmin = points[i].x_;
-        if (points[i].x_ > tmax) tmax = points[i].x_;
-        if (points[i].y_ < rmin) rmin = points[i].y_;
-        if (points[i].y_ > rmax) rmax = points[i].y_;
+    if ( rmax - rmin >= M_INFINITY )
+        return false;
+
+    // a flat signal still needs a range to draw in, it sits in the middle
+    if ( rmax - rmin < M_LARGE_EPSILON )
+    {
+        float pad = Max(Abs(rmin) * 0.1f, MIN_VALUE_RANGE * 0.5f);
+        rmin -= pad;
+        rmax += pad;
     }
 
+    // a short span is shown on the minimum time range, the keys keep their times
+    float maxtime = Max(times.Back(), times.Front() + MIN_TIME_RANGE);
+
     SetValueRange(rmin, rmax);
-    SetTimeRange(tmin, tmax);
-    CurvePointsNormalized(points, outPoints);
+    SetTimeRange(times.Front(), maxtime);
+
+    return true;
 }
 
-void TimeVarInput::CurvePointsNormalized(const PODVector<Vector2> &points, PODVector<IntVector2> &scrnPoints)
+Vector2 TimeVarInput::CurveToLocal(float time, float value) const
 {
-    scrnPoints.Resize(MAX_POINTS);
+    // button centers span the panel minus one button
     IntVector2 scrnSize = GetSize() - controlBoxSize_;
-    Vector2 fscrnSize((float)scrnSize.x_, (float)scrnSize.y_);
+    float x = (float)scrnSize.x_ * (time - timeStart_) / timeRange_;
+    float y = (float)scrnSize.y_ * (1.0f - (value - minValue_) / valueRange_);
 
-    for ( int i = 0; i < MAX_POINTS; ++i )
-    {
-        Vector2 p = points[ i ];
-        p.x_ =  fscrnSize.x_ * ((float)p.x_/timeRange_); 
-        p.y_ =  fscrnSize.y_ - fscrnSize.y_ * (p.y_ - minValue_)/valueRange_;
+    return Vector2(x + (float)(controlBoxSize_.x_/2), y + (float)(controlBoxSize_.y_/2));
+}
+
+IntVector2 TimeVarInput::KeyframeToButtonPos(const Vector2 &keyframe) const
+{
+    IntVector2 scrnSize = GetSize() - controlBoxSize_;
+    Vector2 center = CurveToLocal(keyframe.x_, keyframe.y_);
+    int x = (int)(center.x_ + 0.5f) - controlBoxSize_.x_/2;
+    int y = (int)(center.y_ + 0.5f) - controlBoxSize_.y_/2;
+
+    return IntVector2(Clamp(x, 0, scrnSize.x_), Clamp(y, 0, scrnSize.y_));
+}
+
+Vector2 TimeVarInput::ButtonPosToKeyframe(const IntVector2 &btnPos) const
+{
+    IntVector2 scrnSize = GetSize() - controlBoxSize_;
+    float x = (float)btnPos.x_ / (float)Max(scrnSize.x_, 1);
+    float y = 1.0f - (float)btnPos.y_ / (float)Max(scrnSize.y_, 1);
+
+    return Vector2(timeStart_ + timeRange_ * x, minValue_ + valueRange_ * y);
+}
 
-        scrnPoints[ i ] = IntVector2((int)p.x_, (int)p.y_);
+void TimeVarInput::UpdateButtons()
+{
+    for ( unsigned i = 0; i < buttonList_.Size() && i < keyValues_.Size(); ++i )
+    {
+        buttonList_[i]->SetPosition(KeyframeToButtonPos(Vector2(keyTimes_[i / numChannels_], keyValues_[i])));
     }
 }
 
@@ -300,10 +599,19 @@ void TimeVarInput::SetValueRange(float rmin, float rmax)
 {
     assert(rmax > rmin);
 
+    // the keyframes are remapped so the curve keeps its shape on screen
+    float scale = (rmax - rmin) / valueRange_;
+
+    for ( unsigned i = 0; i < keyValues_.Size(); ++i )
+    {
+        keyValues_[i] = rmin + (keyValues_[i] - minValue_) * scale;
+    }
+
     minValue_ = rmin;
     maxValue_ = rmax;
 
     valueRange_ = maxValue_ - minValue_;
+    UpdateCurve();
 
     char buff[20];
     sprintf(buff, "%.1f", minValue_);
@@ -315,12 +623,28 @@ void TimeVarInput::SetValueRange(float rmin, float rmax)
 void TimeVarInput::SetTimeRange(float mintime, float maxtime)
 {
     assert(mintime >= 0.0f);
-    assert(maxtime >= 0.1f);
+    assert(maxtime >= MIN_TIME_RANGE);
+
+    float scale = (maxtime - mintime) / timeRange_;
+
+    for ( unsigned i = 0; i < keyTimes_.Size(); ++i )
+    {
+        keyTimes_[i] = mintime + (keyTimes_[i] - timeStart_) * scale;
+    }
+
+    // exact ends, the remap above can drift by an ulp
+    if ( keyTimes_.Size() )
+    {
+        keyTimes_.Front() = mintime;
+        keyTimes_.Back() = maxtime;
+    }
 
     timeStart_ = mintime;
     timeEnd_ = maxtime;
     timeRange_ = maxtime - mintime;
 
+    UpdateCurve();
+
     char buff[20];
     sprintf(buff, "%.2f", mintime);
     textTimeStart_->SetText( String(buff) );
@@ -328,11 +652,6 @@ void TimeVarInput::SetTimeRange(float mintime, float maxtime)
     textTimeEnd_->SetText( String(buff) );
 }
 
-void TimeVarInput::HandleBaseDragMove(StringHash eventType, VariantMap& eventData)
-{
-    UpdateDrawLine();
-}
-
 void TimeVarInput::HandleButtonDragMove(StringHash eventType, VariantMap& eventData)
 {
     using namespace DragMove;
@@ -351,92 +670,390 @@ void TimeVarInput::HandleButtonDragMove(StringHash eventType, VariantMap& eventD
     btnPos.x_ = ( btnPos.x_ < 0)?0:(btnPos.x_ > scrnSize.x_)?scrnSize.x_:btnPos.x_;
     btnPos.y_ = ( btnPos.y_ < 0)?0:(btnPos.y_ > scrnSize.y_)?scrnSize.y_:btnPos.y_;
 
+    // keep the buttons apart, closer when there are many keyframes
+    unsigned numKeys = keyTimes_.Size();
+    int spacing = Clamp(scrnSize.x_ / (2 * Max((int)numKeys - 1, 1)), 1, BUTTON_SPACING);
+
     for ( unsigned i = 0; i < buttonList_.Size(); ++i )
     {
-        if ( button == buttonList_[i] )
+        if ( button != buttonList_[i] )
+            continue;
+
+        // neighbors on the same channel are one key away
+        unsigned key = i / numChannels_;
+
+        if (key == 0)
+        {
+            btnPos.x_ = 0;
+        }
+        else if (key == numKeys - 1)
+        {
+            btnPos.x_ = scrnSize.x_;
+        }
+        else
         {
-            if (i == 0)
+            if (btnPos.x_ < buttonList_[i - numChannels_]->GetPosition().x_ + spacing )
             {
-                btnPos.x_ = 0;
+                btnPos.x_ = buttonList_[i - numChannels_]->GetPosition().x_ + spacing;
             }
-            else if (i == buttonList_.Size() - 1)
+
+            if (btnPos.x_ > buttonList_[i + numChannels_]->GetPosition().x_ - spacing)
             {
-                btnPos.x_ = scrnSize.x_;
+                btnPos.x_ = buttonList_[i + numChannels_]->GetPosition().x_ - spacing;
             }
-            else
+        }
+
+        // the edit goes to the model, end keys stay pinned to the time range
+        // and a key never passes its neighbors
+        Vector2 keyframe = ButtonPosToKeyframe(btnPos);
+
+        if ( key == 0 )
+        {
+            keyframe.x_ = timeStart_;
+        }
+        else if ( key == numKeys - 1 )
+        {
+            keyframe.x_ = timeEnd_;
+        }
+        else if ( keyframe.x_ <= keyTimes_[key - 1] || keyframe.x_ >= keyTimes_[key + 1] )
+        {
+            keyframe.x_ = keyTimes_[key];
+        }
+
+        keyTimes_[key] = keyframe.x_;
+        keyValues_[i] = keyframe.y_;
+
+        // the channels share the key time, all of its buttons follow
+        for ( unsigned b = key * numChannels_; b < (key + 1) * numChannels_; ++b )
+        {
+            buttonList_[b]->SetPosition(KeyframeToButtonPos(Vector2(keyTimes_[key], keyValues_[b])));
+        }
+
+        if ( !UpdateCurve() )
+            break;
+
+        // a key moves the tangents of its neighbors, so two spans on either side
+        RedrawSpans(key > 1 ? key - 2 : 0, key + 1);
+        break;
+    }
+}
+
+void TimeVarInput::RedrawCurve()
+{
+    if ( lineBatchers_.Empty() || curve_.numSpans_ == 0 )
+        return;
+
+    for ( unsigned ch = 0; ch < numChannels_; ++ch )
+    {
+        lineBatchers_[ch]->SetNumSpans(curve_.numSpans_);
+    }
+
+    RedrawSpans(0, curve_.numSpans_ - 1);
+}
+
+void TimeVarInput::RedrawSpans(unsigned first, unsigned last)
+{
+    if ( lineBatchers_.Empty() || curve_.numSpans_ == 0 )
+        return;
+
+    last = Min(last, curve_.numSpans_ - 1);
+    float pixelsPerTime = (float)(GetSize().x_ - controlBoxSize_.x_) / timeRange_;
+    unsigned stride = curve_.channelStride_;
+
+    for ( unsigned s = first; s <= last; ++s )
+    {
+        // steps scale with the span's width on screen
+        float t0 = curve_.knotTimes_[s];
+        float t1 = curve_.knotTimes_[s + 1];
+        unsigned numSteps = (unsigned)Clamp((int)((t1 - t0) * pixelsPerTime) / PIXELS_PER_LINE_STEP, 1, NUM_PTS_PER_CURVE_SEGMENT * 2);
+        const float *c = curve_.GetSpanCoeffs(s);
+
+        spanPoints_.Resize(numSteps + 1);
+
+        for ( unsigned ch = 0; ch < numChannels_; ++ch )
+        {
+            for ( unsigned k = 0; k <= numSteps; ++k )
             {
-                if (btnPos.x_ < buttonList_[i-1]->GetPosition().x_ + BUTTON_SPACING )
-                {
-                    btnPos.x_ = buttonList_[i-1]->GetPosition().x_ + BUTTON_SPACING;
-                }
-
-                if (btnPos.x_ > buttonList_[i+1]->GetPosition().x_ - BUTTON_SPACING)
-                {
-                    btnPos.x_ = buttonList_[i+1]->GetPosition().x_ - BUTTON_SPACING;
-                }
+                float f = (float)k / (float)numSteps;
+                float v = ((c[ch] * f + c[stride + ch]) * f + c[2 * stride + ch]) * f + c[3 * stride + ch];
+
+                spanPoints_[k] = CurveToLocal(t0 + (t1 - t0) * f, v);
             }
-            button->SetPosition(btnPos);
+
+            lineBatchers_[ch]->DrawSpan(s, spanPoints_);
         }
     }
+}
+
+bool TimeVarInput::UpdateCurve()
+{
+    if ( !curve_.Build(keyTimes_, keyValues_, numChannels_) )
+    {
+        URHO3D_LOGERROR("TimeVarInput: keyframe times must be increasing, curve not updated");
+        return false;
+    }
+
+    MarkDataChanged();
+
+    if ( bakedMode_ )
+    {
+        RequestBake();
+    }
 
-    // updat draw line
-    UpdateDrawLine();
+    return true;
 }
 
-void TimeVarInput::HandleLayoutUpdated(StringHash eventType, VariantMap& eventData)
+void TimeVarInput::SetBakedMode(bool baked, unsigned resolution)
 {
-    UpdateDrawLine();
+    bakedMode_ = baked;
+    lutResolution_ = Max(resolution, 2U);
+    bakedValid_ = false;
+    MarkDataChanged();
+
+    if ( bakedMode_ )
+    {
+        RequestBake();
+    }
+    else
+    {
+        bakedLut_.Clear();
+    }
 }
 
-void TimeVarInput::UpdateDrawLine()
+void TimeVarInput::RequestBake()
 {
-    IntVector2 absPos = GetScreenPosition();
-    IntVector2 scrnSize = GetSize() - controlBoxSize_;
+    bakedValid_ = false;
+    curveSerial_++;
 
-    spline_.Clear();
+    // the table holds one channel, several stay on the exact curve
+    if ( curve_.numSpans_ == 0 || numChannels_ != 1 )
+        return;
 
-    for ( unsigned i = 0; i < buttonList_.Size(); ++i )
+    // one bake in flight at a time, edits during it are coalesced
+    if ( bakeItem_ )
+    {
+        bakePending_ = true;
+        return;
+    }
+
+    bakePending_ = false;
+
+    bakeJob_ = new CurveBakeJob();
+    bakeJob_->curve_       = curve_;
+    bakeJob_->timeStart_   = timeStart_;
+    bakeJob_->timeRange_   = timeEnd_ - timeStart_;
+    bakeJob_->resolution_  = lutResolution_;
+    bakeJob_->serial_      = curveSerial_;
+
+    WorkQueue *queue = GetSubsystem<WorkQueue>();
+
+    if ( queue == NULL )
+    {
+        BakeCurve(bakeJob_);
+        bakedLut_.Swap(bakeJob_->lut_);
+        lutScale_ = (float)lutResolution_ / bakeJob_->timeRange_;
+        bakedErrorBound_ = bakeJob_->errorBound_;
+        bakedValid_ = true;
+        bakeJob_.Reset();
+        return;
+    }
+
+    bakeItem_ = queue->GetFreeItem();
+    bakeItem_->workFunction_ = BakeCurveWork;
+    bakeItem_->aux_ = bakeJob_;
+    bakeItem_->priority_ = 0;
+    bakeItem_->sendEvent_ = true;
+
+    SubscribeToEvent(E_WORKITEMCOMPLETED, URHO3D_HANDLER(TimeVarInput, HandleWorkItemCompleted));
+    queue->AddWorkItem(bakeItem_);
+}
+
+void TimeVarInput::BakeCurveWork(const WorkItem *item, unsigned threadIndex)
+{
+    BakeCurve((CurveBakeJob*)item->aux_);
+}
+
+void TimeVarInput::BakeCurve(CurveBakeJob *job)
+{
+    const CurveSpans &curve = job->curve_;
+    float step = job->timeRange_ / (float)job->resolution_;
+    unsigned span = 0;
+
+    job->lut_.Resize(job->resolution_ + 1);
+
+    for ( unsigned i = 0; i <= job->resolution_; ++i )
+    {
+        job->lut_[i] = curve.Evaluate(job->timeStart_ + step * (float)i, span);
+    }
+
+    job->errorBound_ = step * step * 0.125f * curve.GetMaxSecondDerivative(0);
+}
+
+void TimeVarInput::FinishBake()
+{
+    // results of an outdated snapshot are dropped
+    if ( bakeJob_->serial_ == curveSerial_ && bakedMode_ )
     {
-        IntVector2 btnPos = buttonList_[i]->GetPosition();
-        absolutePositionList_[i] = btnPos + absPos + controlBoxSize_/2;
+        bakedLut_.Swap(bakeJob_->lut_);
+        lutScale_ = (float)lutResolution_ / bakeJob_->timeRange_;
+        bakedErrorBound_ = bakeJob_->errorBound_;
+        bakedValid_ = true;
 
-        Vector2 v0((float)btnPos.x_, (float)(scrnSize.y_ - btnPos.y_));
-        spline_.AddKnot( v0 );
+        // the table answers within the error bound of the exact values
+        MarkDataChanged();
     }
 
-    lineBatcher_->DrawPoints(absolutePositionList_);
+    bakeItem_.Reset();
+    bakeJob_.Reset();
+
+    if ( bakePending_ && bakedMode_ )
+    {
+        RequestBake();
+    }
 }
 
-float TimeVarInput::GetValueRangeMin(const String &varName)
+bool TimeVarInput::FitDataCurvePoints(const PODVector<Vector2> &samples, unsigned maxKeyframes, float maxError)
 {
-    if ( varName == variableName_ )
+    if ( samples.Size() < 2 || !(samples[0].x_ >= 0.0f) || samples.Back().x_ >= M_INFINITY )
+        return false;
+
+    // the ranges are padded when the fit is installed, only unusable samples are rejected here
+    for ( unsigned i = 0; i < samples.Size(); ++i )
+    {
+        if ( IsNaN(samples[i].y_) || Abs(samples[i].y_) >= M_INFINITY )
+            return false;
+
+        if ( i > 0 && !(samples[i].x_ > samples[i - 1].x_) )
+            return false;
+    }
+
+    SharedPtr<CurveFitJob> job(new CurveFitJob());
+    job->samples_      = samples;
+    job->maxKeyframes_ = maxKeyframes;
+    job->maxError_     = maxError;
+    job->success_      = false;
+
+    // one fit in flight, only the latest request waits behind it
+    if ( fitItem_ )
+    {
+        nextFitJob_ = job;
+        return true;
+    }
+
+    StartFit(job);
+
+    return true;
+}
+
+void TimeVarInput::StartFit(CurveFitJob *job)
+{
+    fitJob_ = job;
+
+    WorkQueue *queue = GetSubsystem<WorkQueue>();
+
+    if ( queue == NULL )
+    {
+        fitJob_->success_ = fitJob_->fitter_.Fit(fitJob_->samples_, fitJob_->maxKeyframes_, fitJob_->maxError_);
+        FinishFit();
+        return;
+    }
+
+    fitItem_ = queue->GetFreeItem();
+    fitItem_->workFunction_ = FitCurveWork;
+    fitItem_->aux_ = fitJob_;
+    fitItem_->priority_ = 0;
+    fitItem_->sendEvent_ = true;
+
+    SubscribeToEvent(E_WORKITEMCOMPLETED, URHO3D_HANDLER(TimeVarInput, HandleWorkItemCompleted));
+    queue->AddWorkItem(fitItem_);
+}
+
+void TimeVarInput::FitCurveWork(const WorkItem *item, unsigned threadIndex)
+{
+    CurveFitJob *job = (CurveFitJob*)item->aux_;
+
+    job->success_ = job->fitter_.Fit(job->samples_, job->maxKeyframes_, job->maxError_);
+}
+
+void TimeVarInput::FinishFit()
+{
+    SharedPtr<CurveFitJob> job = fitJob_;
+
+    fitItem_.Reset();
+    fitJob_.Reset();
+
+    // superseded results are dropped
+    if ( nextFitJob_ )
+    {
+        SharedPtr<CurveFitJob> next = nextFitJob_;
+        nextFitJob_.Reset();
+        StartFit(next);
+        return;
+    }
+
+    if ( !job->success_ || !InitDataCurvePoints(job->fitter_.GetKeyframes()) )
+    {
+        URHO3D_LOGWARNING("TimeVarInput: curve fit failed, keeping the current curve");
+        return;
+    }
+
+    fitError_ = job->fitter_.GetMaxError();
+}
+
+void TimeVarInput::HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData)
+{
+    using namespace WorkItemCompleted;
+
+    RefCounted *item = eventData[P_ITEM].GetPtr();
+
+    if ( item == NULL )
+        return;
+
+    if ( item == bakeItem_.Get() )
+    {
+        FinishBake();
+    }
+    else if ( item == fitItem_.Get() )
+    {
+        FinishFit();
+    }
+
+    if ( !bakeItem_ && !fitItem_ )
+    {
+        UnsubscribeFromEvent(E_WORKITEMCOMPLETED);
+    }
+}
+
+float TimeVarInput::GetValueRangeMin(StringHash varId)
+{
+    if ( varId == variableHash_ )
     {
         return minValue_;
     }
     return 0.0f;
 }
 
-float TimeVarInput::GetValueRangeMax(const String &varName)
+float TimeVarInput::GetValueRangeMax(StringHash varId)
 {
-    if ( varName == variableName_ )
+    if ( varId == variableHash_ )
     {
         return maxValue_;
     }
     return 0.0f;
 }
 
-float TimeVarInput::GetStartTime(const String &varName)
+float TimeVarInput::GetStartTime(StringHash varId)
 {
-    if ( varName == variableName_ )
+    if ( varId == variableHash_ )
     {
         return timeStart_;
     }
     return 0.0f;
 }
 
-float TimeVarInput::GetEndTime(const String &varName)
+float TimeVarInput::GetEndTime(StringHash varId)
 {
-    if ( varName == variableName_ )
+    if ( varId == variableHash_ )
     {
         return timeEnd_;
     }
@@ -445,24 +1062,144 @@ float TimeVarInput::GetEndTime(const String &varName)
 
 float TimeVarInput::GetValueAtTime(float time)
 {
-    float atTime = time<timeStart_?timeStart_:time>timeEnd_?timeEnd_:time;
-    atTime /= timeRange_;
+    if ( curve_.numSpans_ == 0 )
+        return minValue_;
 
-    IntVector2 scrnSize = GetSize() - controlBoxSize_;
-    Vector2 scrn((float)scrnSize.x_, (float)scrnSize.y_);
-    Vector2 v1 = spline_.GetPoint( atTime ).GetVector2();
-    float pctScale = ((float)v1.y_) / (float)scrn.y_;
-    float val = valueRange_ * pctScale + minValue_;
+    if ( bakedValid_ )
+    {
+        float x = (Clamp(time, timeStart_, timeEnd_) - timeStart_) * lutScale_;
+        unsigned idx = Min((unsigned)x, lutResolution_ - 1);
+        return Lerp(bakedLut_[idx], bakedLut_[idx + 1], x - (float)idx);
+    }
+
+    return curve_.Evaluate(time, lastSpan_);
+}
+
+void TimeVarInput::GetValuesAtTimes(const float *times, float *out, unsigned n)
+{
+    if ( curve_.numSpans_ == 0 )
+    {
+        for ( unsigned i = 0; i < n; ++i )
+            out[i] = minValue_;
+        return;
+    }
+
+    if ( bakedValid_ )
+    {
+        for ( unsigned i = 0; i < n; ++i )
+        {
+            float x = (Clamp(times[i], timeStart_, timeEnd_) - timeStart_) * lutScale_;
+            unsigned idx = Min((unsigned)x, lutResolution_ - 1);
+            out[i] = Lerp(bakedLut_[idx], bakedLut_[idx + 1], x - (float)idx);
+        }
+        return;
+    }
+
+    // the span hint carries over between samples
+    unsigned hint = lastSpan_;
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    // span lookup per sample, then the cubic for four samples at once, one channel only
+    if ( curve_.channelStride_ == 1 )
+    {
+        const float *coeffs = &curve_.coeffs_[0];
+        float f[4];
+        unsigned span[4];
+
+        for ( ; i + 4 <= n; i += 4 )
+        {
+            for ( unsigned k = 0; k < 4; ++k )
+            {
+                f[k] = curve_.GetSpanParam(times[i + k], hint);
+                span[k] = hint;
+            }
+
+            __m128 a = _mm_loadu_ps(coeffs + span[0] * 4);
+            __m128 b = _mm_loadu_ps(coeffs + span[1] * 4);
+            __m128 c = _mm_loadu_ps(coeffs + span[2] * 4);
+            __m128 d = _mm_loadu_ps(coeffs + span[3] * 4);
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+
+            __m128 vf = _mm_loadu_ps(f);
+            __m128 v = _mm_add_ps(_mm_mul_ps(a, vf), b);
+            v = _mm_add_ps(_mm_mul_ps(v, vf), c);
+            v = _mm_add_ps(_mm_mul_ps(v, vf), d);
+
+            _mm_storeu_ps(out + i, v);
+        }
+    }
+#endif
+
+    for ( ; i < n; ++i )
+    {
+        out[i] = curve_.Evaluate(times[i], hint);
+    }
+
+    lastSpan_ = hint;
+}
+
+void TimeVarInput::GetChannelValuesAtTime(float time, float *out)
+{
+    // a single channel answers like the scalar query, baked table included
+    if ( numChannels_ == 1 )
+    {
+        out[0] = GetValueAtTime(time);
+        return;
+    }
+
+    if ( curve_.numSpans_ == 0 )
+    {
+        for ( unsigned ch = 0; ch < numChannels_; ++ch )
+            out[ch] = minValue_;
+        return;
+    }
+
+    curve_.EvaluateChannels(time, lastSpan_, out);
+}
+
+void TimeVarInput::GetChannelValuesAtTimes(const float *times, float *out, unsigned n)
+{
+    if ( numChannels_ == 1 )
+    {
+        GetValuesAtTimes(times, out, n);
+        return;
+    }
 
-    return val;
+    if ( curve_.numSpans_ == 0 )
+    {
+        for ( unsigned i = 0; i < n * numChannels_; ++i )
+            out[i] = minValue_;
+        return;
+    }
+
+    // one span lookup per time serves every channel
+    unsigned hint = lastSpan_;
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        curve_.EvaluateChannels(times[i], hint, out + i * numChannels_);
+    }
+
+    lastSpan_ = hint;
 }
 
-float TimeVarInput::GetValueAtTime(const String &varName, float time)
+float TimeVarInput::GetValueAtTime(StringHash varId, float time)
 {
-    if ( varName == variableName_ )
+    if ( varId == variableHash_ )
     {
         return GetValueAtTime(time);
     }
     return 0.0f;
 }
 
+void TimeVarInput::GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n)
+{
+    if ( varId == variableHash_ )
+    {
+        GetValuesAtTimes(times, out, n);
+        return;
+    }
+    memset(out, 0, n * sizeof(float));
+}
+
@@ -20,16 +20,94 @@
 // THE SOFTWARE.
 //
 #pragma once
-#include <Urho3D/Core/Spline.h>
-
 #include "IOElement.h"
 #include "LineBatcher.h"
+#include "CurveFitter.h"
+
+namespace Urho3D
+{
+class WorkItem;
+}
+//=============================================================================
+//=============================================================================
+#define DEFAULT_NUM_KEYFRAMES   5
+#define DEFAULT_CURVE_LUT_SIZE  256
+#define MAX_CURVE_CHANNELS      4
+
+//=============================================================================
+// model space curve built from keyframes: catmull-rom tangents scaled to
+// each span's length, stored as one cubic per span. up to four channels
+// (Vector2/Vector3/Color) share the knot times, so one span lookup serves
+// all of them. evaluation only reads this data, a copy can be used from any
+// thread
+//=============================================================================
+struct CurveSpans
+{
+    CurveSpans() : numSpans_(0), numChannels_(1), channelStride_(1) {}
+
+    void Clear();
+    bool Build(const PODVector<Vector2> &keyframes);
+
+    // values hold numChannels entries per key
+    bool Build(const PODVector<float> &times, const PODVector<float> &values, unsigned numChannels);
+
+    // binary search, unless the hint or the span after it already holds the
+    // time; monotonic queries pass the last result back in and stay O(1)
+    unsigned FindSpan(float time, unsigned hint = M_MAX_UNSIGNED) const;
+
+    // span is the hint going in and the found span coming out
+    float GetSpanParam(float time, unsigned &span) const;
+    const float* GetSpanCoeffs(unsigned span) const { return &coeffs_[span * 4 * channelStride_]; }
+
+    // first channel
+    float Evaluate(float time, unsigned &span) const;
+    float Evaluate(float time) const;
+
+    // all channels into out[numChannels_]
+    void EvaluateChannels(float time, unsigned &span, float *out) const;
+    float GetMaxSecondDerivative(unsigned channel = 0) const;
+
+    // span i covers [knotTimes_[i], knotTimes_[i + 1]]
+    PODVector<float> knotTimes_;
+    PODVector<float> invLengths_;
+
+    // per span cubic (a,b,c,d): v = ((a*f + b)*f + c)*f + d, f in [0, 1].
+    // each coefficient is channelStride_ wide, one per channel, so the
+    // channels of a span evaluate in one simd register
+    PODVector<float> coeffs_;
+    unsigned         numSpans_;
+    unsigned         numChannels_;
+    unsigned         channelStride_;
+};
 
 //=============================================================================
+// snapshot of a curve handed to a worker thread for baking
 //=============================================================================
-enum MaxPoint
+struct CurveBakeJob : public RefCounted
 {
-    MAX_POINTS = 5
+    CurveSpans       curve_;
+    float            timeStart_;
+    float            timeRange_;
+    unsigned         resolution_;
+    unsigned         serial_;
+
+    // results
+    PODVector<float> lut_;
+    float            errorBound_;
+};
+
+//=============================================================================
+// dense samples handed to a worker thread for fitting
+//=============================================================================
+struct CurveFitJob : public RefCounted
+{
+    PODVector<Vector2> samples_;
+    unsigned           maxKeyframes_;
+    float              maxError_;
+
+    // results
+    CurveFitter        fitter_;
+    bool               success_;
 };
 
 //=============================================================================
@@ -45,13 +123,63 @@ public:
 
     virtual bool Create(const String &variableName, const IntVector2 &size);
 
-    virtual float GetValueRangeMin(const String &varName);
-    virtual float GetValueRangeMax(const String &varName);
-    virtual float GetStartTime(const String &varName);
-    virtual float GetEndTime(const String &varName);
-    virtual float GetValueAtTime(const String &varName, float time);
+    virtual float GetValueRangeMin(StringHash varId);
+    virtual float GetValueRangeMax(StringHash varId);
+    virtual float GetStartTime(StringHash varId);
+    virtual float GetEndTime(StringHash varId);
+    virtual float GetValueAtTime(StringHash varId, float time);
+    virtual void GetValuesAtTimes(StringHash varId, const float *times, float *out, unsigned n);
+
+    using IOElement::GetValueRangeMin;
+    using IOElement::GetValueRangeMax;
+    using IOElement::GetStartTime;
+    using IOElement::GetEndTime;
+    using IOElement::GetValueAtTime;
+    using IOElement::GetValuesAtTimes;
+
+    // direct access for compiled graph programs
+    float GetValueAtTime(float time);
+    void GetValuesAtTimes(const float *times, float *out, unsigned n);
+    float GetValueRangeMin() const { return minValue_;  }
+    float GetValueRangeMax() const { return maxValue_;  }
+    float GetStartTime() const     { return timeStart_; }
+    float GetEndTime() const       { return timeEnd_;   }
+
+    // every channel per time, out is interleaved: n * GetNumChannels() floats
+    void GetChannelValuesAtTime(float time, float *out);
+    void GetChannelValuesAtTimes(const float *times, float *out, unsigned n);
+    unsigned GetNumChannels() const { return numChannels_; }
+
+    // baked mode: the curve is sampled into a table of resolution + 1 entries
+    // and queries interpolate linearly between them. the error against the
+    // curve is at most h^2/8 * max|v''(t)|, h = time range / resolution,
+    // GetBakedErrorBound() returns that bound for the current curve.
+    // rebakes run on the work queue, exact evaluation is used until one lands.
+    // only single-channel curves are baked, several channels stay exact
+    void SetBakedMode(bool baked, unsigned resolution = DEFAULT_CURVE_LUT_SIZE);
+    bool IsBakedMode() const            { return bakedMode_; }
+    bool IsBakedValid() const           { return bakedValid_; }
+    float GetBakedErrorBound() const    { return bakedErrorBound_; }
 
+    // keyframes are (time, value) pairs in model space with increasing times,
+    // any count from 2 up. the buttons are a view of them
     bool InitDataCurvePoints(const PODVector<Vector2> &points);
+
+    // multi-channel curve, values hold numChannels entries per key time
+    bool InitDataCurveChannels(const PODVector<float> &times, const PODVector<float> &values, unsigned numChannels);
+
+    unsigned GetNumKeyframes() const                        { return keyTimes_.Size(); }
+    float GetKeyTime(unsigned key) const                    { return keyTimes_[key]; }
+    float GetKeyValue(unsigned key, unsigned channel) const { return keyValues_[key * numChannels_ + channel]; }
+
+    // imports recorded data: a curve is fitted to the samples on the work queue
+    // and replaces the keyframes when it lands. a newer request supersedes one
+    // still in flight. maxError 0 spends the whole keyframe budget. a flat
+    // signal or a very short recording is shown on padded ranges
+    bool FitDataCurvePoints(const PODVector<Vector2> &samples, unsigned maxKeyframes = DEFAULT_FIT_MAX_KEYFRAMES, float maxError = 0.0f);
+    bool IsFitPending() const   { return fitItem_ != NULL; }
+    float GetFitError() const   { return fitError_; }
+
     void SetValueRange(float rmin, float rmax);
     void SetTimeRange(float mintime, float maxtime);
 
@@ -61,16 +189,29 @@ protected:
     Text* CreateText(int size, const IntVector2 &pos);
     bool CreateButtons();
     bool CreateLineBatcher(LineType linetype, const Color& color, float pixelSize);
+    void UpdateChannelLines();
 
-    void EvaluateCurvePoints(const PODVector<Vector2> &points, PODVector<IntVector2> &outPoints);
-    void CurvePointsNormalized(const PODVector<Vector2> &points, PODVector<IntVector2> &scrnPoints);
+    bool EvaluateCurveRanges(const PODVector<float> &times, const PODVector<float> &values);
+    Vector2 CurveToLocal(float time, float value) const;
+    IntVector2 KeyframeToButtonPos(const Vector2 &keyframe) const;
+    Vector2 ButtonPosToKeyframe(const IntVector2 &btnPos) const;
+    void UpdateButtons();
 
-    void HandleBaseDragMove(StringHash eventType, VariantMap& eventData);
     void HandleButtonDragMove(StringHash eventType, VariantMap& eventData);
-    void HandleLayoutUpdated(StringHash eventType, VariantMap& eventData);
 
-    void  UpdateDrawLine();
-    float GetValueAtTime(float time);
+    void  RedrawCurve();
+    void  RedrawSpans(unsigned first, unsigned last);
+    bool  UpdateCurve();
+    void  RequestBake();
+    void  FinishBake();
+    static void BakeCurve(CurveBakeJob *job);
+    static void BakeCurveWork(const WorkItem *item, unsigned threadIndex);
+
+    void  StartFit(CurveFitJob *job);
+    void  FinishFit();
+    static void FitCurveWork(const WorkItem *item, unsigned threadIndex);
+
+    void  HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData);
 
 protected:
     WeakPtr<Text>         textTitle_;
@@ -79,16 +220,39 @@ protected:
     WeakPtr<Text>         textTimeStart_;
     WeakPtr<Text>         textTimeEnd_;
 
-    WeakPtr<LineBatcher>  lineBatcher_;
+    // one line per channel, the buttons are key * numChannels_ + channel
+    Vector<WeakPtr<LineBatcher> > lineBatchers_;
     Vector<Button*>       buttonList_;
     LineType              linetype_;
     float                 pixelSize_;
 
-    PODVector<IntVector2> absolutePositionList_;
-    PODVector<IntVector2> pointList_;
     IntVector2            controlBoxSize_;
+    PODVector<Vector2>    spanPoints_;
+
+    // source of truth, everything on screen is derived from it
+    PODVector<float>      keyTimes_;
+    PODVector<float>      keyValues_;
+    unsigned              numChannels_;
+    CurveSpans            curve_;
+    unsigned              lastSpan_;
+
+    // baked mode
+    PODVector<float>      bakedLut_;
+    float                 lutScale_;
+    float                 bakedErrorBound_;
+    unsigned              lutResolution_;
+    unsigned              curveSerial_;
+    bool                  bakedMode_;
+    bool                  bakedValid_;
+    bool                  bakePending_;
+    SharedPtr<WorkItem>   bakeItem_;
+    SharedPtr<CurveBakeJob> bakeJob_;
 
-    Spline                spline_;
+    // curve fitting
+    SharedPtr<WorkItem>   fitItem_;
+    SharedPtr<CurveFitJob> fitJob_;
+    SharedPtr<CurveFitJob> nextFitJob_;
+    float                 fitError_;
 
     float                 minValue_;
     float                 maxValue_;
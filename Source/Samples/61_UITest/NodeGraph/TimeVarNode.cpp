@@ -73,6 +73,16 @@ bool TimeVarNode::InitDataCurvePoints(const PODVector<Vector2> &points)
     return timeVarInput_->InitDataCurvePoints(points);
 }
 
+bool TimeVarNode::InitDataCurveChannels(const PODVector<float> &times, const PODVector<float> &values, unsigned numChannels)
+{
+    return timeVarInput_->InitDataCurveChannels(times, values, numChannels);
+}
+
+bool TimeVarNode::FitDataCurvePoints(const PODVector<Vector2> &samples, unsigned maxKeyframes, float maxError)
+{
+    return timeVarInput_->FitDataCurvePoints(samples, maxKeyframes, maxError);
+}
+
 void TimeVarNode::SetValueRange(float rmin, float rmax)
 {
     timeVarInput_->SetValueRange(rmin, rmax);
@@ -83,6 +93,11 @@ void TimeVarNode::SetTimeRange(float mintime, float maxtime)
     timeVarInput_->SetTimeRange(mintime, maxtime);
 }
 
+void TimeVarNode::SetBakedMode(bool baked, unsigned resolution)
+{
+    timeVarInput_->SetBakedMode(baked, resolution);
+}
+
 bool TimeVarNode::ConnectToInput(InputNode *inputNode)
 {
     return outputNode_->ConnectToInput(inputNode);
@@ -23,6 +23,7 @@
 #include <Urho3D/Core/Spline.h>
 
 #include "GraphNode.h"
+#include "TimeVarInput.h"
 
 class TimeVarInput;
 class InputNode;
@@ -45,8 +46,11 @@ public:
     OutputNode* GetOutputNodeElement() { return outputNode_;   }
 
     bool InitDataCurvePoints(const PODVector<Vector2> &points);
+    bool InitDataCurveChannels(const PODVector<float> &times, const PODVector<float> &values, unsigned numChannels);
+    bool FitDataCurvePoints(const PODVector<Vector2> &samples, unsigned maxKeyframes = DEFAULT_FIT_MAX_KEYFRAMES, float maxError = 0.0f);
     void SetValueRange(float rmin, float rmax);
     void SetTimeRange(float mintime, float maxtime);
+    void SetBakedMode(bool baked, unsigned resolution = DEFAULT_CURVE_LUT_SIZE);
 
     void SetEnableCtrlButton(bool enable);
     bool ConnectToInput(InputNode *inputNode);
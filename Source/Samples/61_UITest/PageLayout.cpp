@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/IO/Serializer.h>
+#include <Urho3D/IO/Deserializer.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/UI/UIElement.h>
+
+#include "PageLayout.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define LAYOUT_FILE_ID          "ULYT"
+#define LAYOUT_FILE_VERSION     1
+
+//=============================================================================
+//=============================================================================
+PageLayout::PageLayout(Context *context)
+    : Object(context)
+{
+}
+
+PageLayout::~PageLayout()
+{
+}
+
+bool PageLayout::SaveLayout(UIElement *root, Serializer &dest)
+{
+    if ( root == NULL )
+        return false;
+
+    dest.WriteFileID(LAYOUT_FILE_ID);
+    dest.WriteVLE(LAYOUT_FILE_VERSION);
+    dest.WriteVLE(root->GetNumChildren());
+
+    for ( unsigned i = 0; i < root->GetNumChildren(); ++i )
+    {
+        if ( !SaveElement(root->GetChild(i), dest) )
+            return false;
+    }
+
+    return true;
+}
+
+bool PageLayout::SaveElement(UIElement *element, Serializer &dest)
+{
+    dest.WriteUInt(element->GetType().Value());
+
+    if ( !element->Save(dest) )
+        return false;
+
+    dest.WriteVLE(element->GetNumChildren());
+
+    for ( unsigned i = 0; i < element->GetNumChildren(); ++i )
+    {
+        if ( !SaveElement(element->GetChild(i), dest) )
+            return false;
+    }
+
+    return true;
+}
+
+bool PageLayout::LoadLayout(UIElement *root, Deserializer &source)
+{
+    if ( root == NULL || source.ReadFileID() != LAYOUT_FILE_ID )
+        return false;
+
+    if ( source.ReadVLE() != LAYOUT_FILE_VERSION )
+    {
+        URHO3D_LOGERROR("PageLayout: unsupported layout version");
+        return false;
+    }
+
+    // layout is updated once for the whole subtree at the end, on failure the
+    // new children of the root are never attached
+    root->DisableLayoutUpdate();
+    bool result = LoadChildren(root, source);
+    root->EnableLayoutUpdate();
+    root->UpdateLayout();
+
+    return result;
+}
+
+bool PageLayout::LoadChildren(UIElement *element, Deserializer &source)
+{
+    unsigned numChildren = source.ReadVLE();
+    unsigned numExisting = element->GetNumChildren();
+
+    // every child takes at least its type hash, don't size anything by a corrupt count
+    if ( numChildren > (source.GetSize() - source.GetPosition()) / sizeof(unsigned) )
+    {
+        URHO3D_LOGERROR("PageLayout: invalid child count");
+        return false;
+    }
+
+    // the whole level is created before any of it is attached: a failed load
+    // leaves nothing new behind and the children are added in one go
+    Vector<SharedPtr<UIElement> > children(numChildren);
+
+    for ( unsigned i = 0; i < numChildren; ++i )
+    {
+        StringHash type(source.ReadUInt());
+        UIElement *child = i < numExisting ? element->GetChild(i) : NULL;
+
+        // constructor-created children are loaded in place
+        if ( child == NULL || child->GetType() != type )
+        {
+            children[i] = DynamicCast<UIElement>(context_->CreateObject(type));
+
+            if ( children[i] == NULL )
+            {
+                URHO3D_LOGERRORF("PageLayout: could not create element of type %s", type.ToString().CString());
+                return false;
+            }
+
+            child = children[i];
+        }
+
+        if ( !LoadElement(child, source) )
+            return false;
+    }
+
+    for ( unsigned i = 0; i < numChildren; ++i )
+    {
+        if ( children[i] )
+        {
+            element->AddChild(children[i]);
+        }
+    }
+
+    return true;
+}
+
+bool PageLayout::LoadElement(UIElement *element, Deserializer &source)
+{
+    element->DisableLayoutUpdate();
+
+    bool result = element->Load(source);
+
+    if ( result )
+    {
+        element->ApplyAttributes();
+        result = LoadChildren(element, source);
+    }
+
+    element->EnableLayoutUpdate();
+
+    return result;
+}
+
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/Core/Object.h>
+
+namespace Urho3D
+{
+class UIElement;
+class Serializer;
+class Deserializer;
+}
+
+using namespace Urho3D;
+//=============================================================================
+// binary page layout:
+//   header:  "ULYT", version
+//   element: type hash (uint), attributes (Serializable binary), numChildren (VLE), children..
+// attribute values are saved after styling, resources are saved as refs and
+// resolved through the cache on load. Children that an element already creates
+// in its constructor are matched by index and type and loaded in place.
+//=============================================================================
+class PageLayout : public Object
+{
+    URHO3D_OBJECT(PageLayout, Object);
+public:
+    PageLayout(Context *context);
+    virtual ~PageLayout();
+
+    // saves the children of root, not root itself
+    bool SaveLayout(UIElement *root, Serializer &dest);
+    bool LoadLayout(UIElement *root, Deserializer &source);
+
+protected:
+    bool SaveElement(UIElement *element, Serializer &dest);
+    bool LoadChildren(UIElement *element, Deserializer &source);
+    bool LoadElement(UIElement *element, Deserializer &source);
+};
+
@@ -21,6 +21,8 @@
 //
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Input/InputEvents.h>
 #include <Urho3D/UI/UIEvents.h>
 #include <Urho3D/UI/UI.h>
 #include <Urho3D/UI/Button.h>
@@ -29,9 +31,13 @@
 #include <Urho3D/UI/Text.h>
 #include <Urho3D/UI/CheckBox.h>
 #include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
 #include <Urho3D/Graphics/Texture2D.h>
 
 #include "PageManager.h"
+#include "PageLayout.h"
 #include "LineComponent.h"
 
 #include <Urho3D/DebugNew.h>
@@ -48,6 +54,13 @@ void PageManager::RegisterObject(Context* context)
 }
 
 PageManager::PageManager(Context *context) : Object(context)
+    , currentPageIdx_(0)
+    , buildPageIdx_(-1)
+    , switchCount_(0)
+    , evictionAge_(0)
+    , buildBudgetMsec_(2.0f)
+    , idleTime_(0.5f)
+    , prewarm_(true)
 {
 }
 
@@ -99,13 +112,31 @@ bool PageManager::CreatePages(int numPages)
     text->SetPosition(rootSize_.x_ - 300, 10);
     text->SetTextEffect(TE_SHADOW);
 
+    // shown while the current page is still being built
+    placeholderText_ = controlPage_->CreateChild<Text>();
+    placeholderText_->SetFont(cache->GetResource<Font>("Fonts/DejaVu/DejaVuSerifCondensed-Bold.ttf"), 20);
+    placeholderText_->SetText("loading...");
+    placeholderText_->SetColor(Color::CYAN);
+    placeholderText_->SetAlignment(HA_CENTER, VA_CENTER);
+    placeholderText_->SetVisible(false);
+
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(PageManager, HandleUpdate));
+
+    // any input restarts the idle timer
+    SubscribeToEvent(E_MOUSEMOVE, URHO3D_HANDLER(PageManager, HandleInput));
+    SubscribeToEvent(E_MOUSEBUTTONDOWN, URHO3D_HANDLER(PageManager, HandleInput));
+    SubscribeToEvent(E_MOUSEWHEEL, URHO3D_HANDLER(PageManager, HandleInput));
+    SubscribeToEvent(E_KEYDOWN, URHO3D_HANDLER(PageManager, HandleInput));
+    SubscribeToEvent(E_TOUCHBEGIN, URHO3D_HANDLER(PageManager, HandleInput));
+
     // create pages
     for ( int i = 0; i < numPages; ++i )
     {
-        UIElement *page = root->CreateChild<UIElement>();
-        page->SetSize(rootSize_);
-        page->SetVisible(i==0);
-        pageList_.Push(page);
+        PageElement pageElement;
+        pageElement.root_ = root->CreateChild<UIElement>();
+        pageElement.root_->SetSize(rootSize_);
+        pageElement.root_->SetVisible(i==0);
+        pageList_.Push(pageElement);
     }
 
     return true;
@@ -132,6 +163,10 @@ Button* PageManager::CreateButton(const IntVector2 &pos, const IntRect &rect, co
 
 UIElement* PageManager::GetRoot()
 {
+    // builders create their content through GetRoot()
+    if ( buildPageIdx_ != -1 )
+        return GetPageRoot(buildPageIdx_);
+
     return GetPageRoot(currentPageIdx_);
 }
 
@@ -141,7 +176,7 @@ UIElement* PageManager::GetPageRoot(unsigned idx)
 
     if (idx < pageList_.Size())
     {
-        page = pageList_[idx];
+        page = pageList_[idx].root_;
     }
 
     return page;
@@ -151,14 +186,289 @@ void PageManager::SetPageIndex(int idx)
 {
     if (idx < (int)pageList_.Size())
     {
+        BuildPage(idx);
+        QueuePageBuild(idx, true);
+
         GetPageRoot(currentPageIdx_)->SetVisible(false);
         currentPageIdx_ = idx;
-        GetPageRoot(currentPageIdx_)->SetVisible(true);
+        UpdatePageVisibility();
+
+        pageList_[idx].lastVisit_ = ++switchCount_;
+        EvictPages();
     }
 
     UpdateButtonState(currentPageIdx_);
 }
 
+void PageManager::SetPageBuilder(unsigned idx, PageBuilder *builder)
+{
+    // owned either way
+    SharedPtr<PageBuilder> builderPtr(builder);
+
+    if (idx < pageList_.Size())
+    {
+        pageList_[idx].builder_ = builderPtr;
+        pageList_[idx].layoutFile_.Clear();
+        pageList_[idx].nextStep_ = 0;
+        pageList_[idx].built_ = false;
+    }
+}
+
+void PageManager::SetPageLayout(unsigned idx, const String &layoutFile)
+{
+    if (idx < pageList_.Size())
+    {
+        // a one-shot builder is kept as the fallback for a missing or stale layout
+        if ( pageList_[idx].builder_ && pageList_[idx].builder_->IsStepped() )
+        {
+            pageList_[idx].builder_.Reset();
+        }
+
+        pageList_[idx].layoutFile_ = layoutFile;
+        pageList_[idx].built_ = false;
+    }
+}
+
+bool PageManager::SavePageLayout(unsigned idx, Serializer &dest)
+{
+    if (idx >= pageList_.Size() || !pageList_[idx].built_)
+        return false;
+
+    SharedPtr<PageLayout> pageLayout(new PageLayout(context_));
+
+    return pageLayout->SaveLayout(pageList_[idx].root_, dest);
+}
+
+bool PageManager::QueuePageBuild(unsigned idx, bool urgent)
+{
+    if (idx >= pageList_.Size())
+        return false;
+
+    PageElement &pageElement = pageList_[idx];
+
+    if ( pageElement.built_ || pageElement.builder_ == NULL || !pageElement.builder_->IsStepped() )
+        return false;
+
+    // urgent: the page is about to be shown, move it to the front
+    if ( pageElement.queued_ )
+    {
+        if ( !urgent )
+            return true;
+
+        buildQueue_.Remove(idx);
+    }
+
+    if ( urgent )
+        buildQueue_.Insert(0, idx);
+    else
+        buildQueue_.Push(idx);
+
+    pageElement.queued_ = true;
+
+    return true;
+}
+
+void PageManager::AddPageResource(unsigned idx, StringHash type, const String &name)
+{
+    if (idx < pageList_.Size())
+    {
+        pageList_[idx].resources_.Push(MakePair(type, name));
+        pageList_[idx].warmed_ = false;
+    }
+}
+
+void PageManager::SetPlaceholderText(const String &text)
+{
+    if ( placeholderText_ )
+    {
+        placeholderText_->SetText(text);
+    }
+}
+
+void PageManager::UpdatePageVisibility()
+{
+    bool built = pageList_[currentPageIdx_].built_;
+
+    GetPageRoot(currentPageIdx_)->SetVisible(built);
+
+    if ( placeholderText_ )
+    {
+        placeholderText_->SetVisible(!built);
+    }
+}
+
+void PageManager::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{
+    HiresTimer timer;
+    long long budget = (long long)(buildBudgetMsec_ * 1000.0f);
+
+    // pending builds first, warming only uses what's left of an idle frame
+    if ( buildQueue_.Size() )
+    {
+        RunBuildSteps(timer, budget);
+    }
+    else if ( prewarm_ && idleTimer_.GetMSec(false) >= (unsigned)(idleTime_ * 1000.0f) )
+    {
+        RunPrewarm();
+    }
+}
+
+void PageManager::HandleInput(StringHash eventType, VariantMap& eventData)
+{
+    idleTimer_.Reset();
+}
+
+void PageManager::RunBuildSteps(HiresTimer &timer, long long budget)
+{
+    // at least one step per frame so that a small budget still makes progress
+    while ( buildQueue_.Size() )
+    {
+        unsigned idx = buildQueue_[0];
+        PageElement &pageElement = pageList_[idx];
+
+        buildPageIdx_ = (int)idx;
+        bool done = pageElement.builder_->Invoke(pageElement.root_, pageElement.nextStep_++);
+        buildPageIdx_ = -1;
+
+        if ( done )
+        {
+            pageElement.built_ = true;
+            pageElement.queued_ = false;
+            buildQueue_.Erase(0);
+
+            if ( (int)idx == currentPageIdx_ )
+            {
+                UpdatePageVisibility();
+            }
+        }
+
+        if ( timer.GetUSec(false) >= budget )
+            break;
+    }
+}
+
+void PageManager::RunPrewarm()
+{
+    // the next page first, then the previous one
+    if ( !PrewarmPage(currentPageIdx_ + 1) )
+    {
+        PrewarmPage(currentPageIdx_ - 1);
+    }
+}
+
+bool PageManager::PrewarmPage(int idx)
+{
+    if ( idx < 0 || idx >= (int)pageList_.Size() || pageList_[idx].warmed_ )
+        return false;
+
+    PageElement &pageElement = pageList_[idx];
+
+    // an unbuilt page is built first, in time slices if it has steps. its
+    // resources are requested on a later idle frame once the build is done
+    if ( !pageElement.built_ )
+    {
+        if ( QueuePageBuild(idx) )
+            return true;
+
+        // one-shot builders and layouts can't be sliced, build them whole while idle
+        if ( !BuildPage(idx) )
+            return false;
+    }
+
+    // building the page already laid it out and put its glyphs in the font
+    // textures, what's left is loading the resources it shows later
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    for ( unsigned i = 0; i < pageElement.resources_.Size(); ++i )
+    {
+        const Pair<StringHash, String> &resource = pageElement.resources_[i];
+
+        if ( !cache->GetExistingResource(resource.first_, resource.second_) )
+        {
+            cache->BackgroundLoadResource(resource.first_, resource.second_);
+        }
+    }
+
+    pageElement.warmed_ = true;
+
+    return true;
+}
+
+bool PageManager::IsPageBuilt(unsigned idx) const
+{
+    return idx < pageList_.Size() && pageList_[idx].built_;
+}
+
+bool PageManager::BuildPage(unsigned idx)
+{
+    if (idx >= pageList_.Size())
+        return false;
+
+    PageElement &pageElement = pageList_[idx];
+
+    if ( pageElement.built_ )
+        return false;
+
+    // precompiled layout, instantiated in one pass
+    if ( !pageElement.layoutFile_.Empty() )
+    {
+        SharedPtr<File> file;
+        SharedPtr<PageLayout> pageLayout(new PageLayout(context_));
+
+        if ( IsAbsolutePath(pageElement.layoutFile_) )
+            file = new File(context_, pageElement.layoutFile_);
+        else
+            file = GetSubsystem<ResourceCache>()->GetFile(pageElement.layoutFile_);
+
+        if ( file && file->IsOpen() && pageLayout->LoadLayout(pageElement.root_, *file) )
+        {
+            pageElement.built_ = true;
+            return true;
+        }
+
+        // don't leave a partial page behind for the builder or the next attempt to duplicate
+        URHO3D_LOGWARNINGF("PageManager: could not load page layout %s", pageElement.layoutFile_.CString());
+        pageElement.root_->RemoveAllChildren();
+        pageElement.layoutFile_.Clear();
+    }
+
+    if ( pageElement.builder_ == NULL || pageElement.builder_->IsStepped() )
+        return false;
+
+    int prevBuildIdx = buildPageIdx_;
+    buildPageIdx_ = (int)idx;
+
+    pageElement.builder_->Invoke(pageElement.root_, 0);
+
+    buildPageIdx_ = prevBuildIdx;
+    pageElement.built_ = true;
+
+    return true;
+}
+
+void PageManager::EvictPages()
+{
+    if ( evictionAge_ == 0 )
+        return;
+
+    // only pages that can be rebuilt are destroyed
+    for ( unsigned i = 0; i < pageList_.Size(); ++i )
+    {
+        PageElement &pageElement = pageList_[i];
+
+        if ( (int)i == currentPageIdx_ || !pageElement.built_ || !pageElement.HasBuilder() )
+            continue;
+
+        if ( switchCount_ - pageElement.lastVisit_ > evictionAge_ )
+        {
+            pageElement.root_->RemoveAllChildren();
+            pageElement.nextStep_ = 0;
+            pageElement.built_ = false;
+            pageElement.warmed_ = false;
+        }
+    }
+}
+
 int PageManager::GetPageIndex()
 {
     return currentPageIdx_;
@@ -21,14 +21,90 @@
 //
 #pragma once
 #include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
 //#include <Urho3D/UI/CheckBox.h>
 
 namespace Urho3D
 {
 extern const char* UI_CATEGORY;
 class Button;
+class Text;
+class Serializer;
 }
 using namespace Urho3D;
+//=============================================================================
+//=============================================================================
+// page builder bound to a receiver's member function, same idea as EventHandlerImpl
+class PageBuilder : public RefCounted
+{
+public:
+    virtual ~PageBuilder() {}
+
+    // called with step = 0, 1, 2.. once per call until it returns true
+    virtual bool Invoke(UIElement *pageRoot, unsigned step) = 0;
+    // stepped builders are time-sliced, one-shot builders run when the page is first shown
+    virtual bool IsStepped() const = 0;
+};
+
+template <class T> class PageBuilderImpl : public PageBuilder
+{
+public:
+    typedef void (T::*BuilderFunctionPtr)(UIElement *pageRoot);
+
+    PageBuilderImpl(T *receiver, BuilderFunctionPtr function) : receiver_(receiver), function_(function)
+    {
+        assert(receiver_ && function_);
+    }
+
+    virtual bool Invoke(UIElement *pageRoot, unsigned step) { (receiver_->*function_)(pageRoot); return true; }
+    virtual bool IsStepped() const { return false; }
+
+private:
+    T                  *receiver_;
+    BuilderFunctionPtr  function_;
+};
+
+template <class T> class PageBuildStepImpl : public PageBuilder
+{
+public:
+    typedef bool (T::*StepFunctionPtr)(UIElement *pageRoot, unsigned step);
+
+    PageBuildStepImpl(T *receiver, StepFunctionPtr function) : receiver_(receiver), function_(function)
+    {
+        assert(receiver_ && function_);
+    }
+
+    virtual bool Invoke(UIElement *pageRoot, unsigned step) { return (receiver_->*function_)(pageRoot, step); }
+    virtual bool IsStepped() const { return true; }
+
+private:
+    T                  *receiver_;
+    StepFunctionPtr     function_;
+};
+
+#define PAGE_BUILDER(className, function) (new PageBuilderImpl<className>(this, &className::function))
+#define PAGE_BUILD_STEPS(className, function) (new PageBuildStepImpl<className>(this, &className::function))
+
+struct PageElement
+{
+    PageElement() 
+        : nextStep_(0), lastVisit_(0), built_(true), queued_(false), warmed_(false) {}
+
+    bool HasBuilder() const { return builder_ || !layoutFile_.Empty(); }
+
+    WeakPtr<UIElement>    root_;
+    SharedPtr<PageBuilder> builder_;
+    String                layoutFile_;
+    unsigned              nextStep_;
+    unsigned              lastVisit_;
+    bool                  built_;
+    bool                  queued_;
+    bool                  warmed_;
+
+    // loaded in the background when the page is warmed
+    Vector<Pair<StringHash, String> > resources_;
+};
+
 //=============================================================================
 //=============================================================================
 class PageManager : public Object
@@ -49,16 +125,62 @@ public:
     void SetPageIndex(int idx);
     int GetPageIndex();
 
+    // pages with a builder are built the first time they're shown, takes
+    // ownership, e.g. SetPageBuilder(0, PAGE_BUILDER(Main, BuildPage))
+    void SetPageBuilder(unsigned idx, PageBuilder *builder);
+    bool IsPageBuilt(unsigned idx) const;
+    bool BuildPage(unsigned idx);
+
+    // time-sliced build, PAGE_BUILD_STEPS: steps run from the update within the per-frame
+    // budget, the page stays hidden behind a placeholder until its last step is done
+    bool QueuePageBuild(unsigned idx, bool urgent = false);
+    void SetBuildBudget(float msec) { buildBudgetMsec_ = msec; }
+    void SetPlaceholderText(const String &text);
+
+    // binary layouts, see PageLayout. a resource name or an absolute path, set it
+    // after SetPageBuilder to keep a one-shot builder as the fallback
+    void SetPageLayout(unsigned idx, const String &layoutFile);
+    bool SavePageLayout(unsigned idx, Serializer &dest);
+
+    // while the input is idle the neighbouring pages are warmed: unbuilt pages
+    // built and their resources background loaded
+    void AddPageResource(unsigned idx, StringHash type, const String &name);
+    void SetPrewarm(bool enable)        { prewarm_ = enable; }
+    void SetIdleTime(float seconds)     { idleTime_ = seconds; }
+
+    // destroy built pages not visited for numSwitches page switches, 0 = never
+    void SetEvictionAge(unsigned numSwitches) { evictionAge_ = numSwitches; }
+
 protected:
     Button* CreateButton(const IntVector2 &pos, const IntRect &rect, const Color &color);
     void UpdateButtonState(int idx);
+    void EvictPages();
+    void UpdatePageVisibility();
+    void RunBuildSteps(HiresTimer &timer, long long budget);
+    void RunPrewarm();
+    bool PrewarmPage(int idx);
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleInput(StringHash eventType, VariantMap& eventData);
     void HandleButtonReleased(StringHash eventType, VariantMap& eventData);
 
 protected:
     WeakPtr<UIElement> controlPage_;
-    Vector<UIElement*> pageList_;
+    Vector<PageElement> pageList_;
     IntVector2         rootSize_;
     int                currentPageIdx_;
+    int                buildPageIdx_;
+    unsigned           switchCount_;
+    unsigned           evictionAge_;
+
+    // build scheduler
+    PODVector<unsigned> buildQueue_;
+    float              buildBudgetMsec_;
+    WeakPtr<Text>      placeholderText_;
+
+    // prewarm
+    Timer              idleTimer_;
+    float              idleTime_;
+    bool               prewarm_;
 
     // buttons
     WeakPtr<Button>    buttonPrev_;
@@ -21,17 +21,25 @@
 //
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/UI/UI.h>
 #include <Urho3D/UI/UIEvents.h>
 #include <Urho3D/UI/Button.h>
 #include <Urho3D/UI/BorderImage.h>
 #include <Urho3D/UI/Font.h>
 #include <Urho3D/UI/Text.h>
 #include <Urho3D/UI/CheckBox.h>
+#include <Urho3D/UI/ScrollBar.h>
 #include <Urho3D/Resource/ResourceCache.h>
 
 #include "RadialGroup.h"
 
 #include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+// item index of a row, set on its checkbox and text so a click is a lookup
+static const StringHash VAR_RADIAL_ITEM("RadialItem");
+
 //=============================================================================
 //=============================================================================
 void RadialText::RegisterObject(Context* context)
@@ -57,6 +65,9 @@ void RadialGroup::RegisterObject(Context* context)
 
 RadialGroup::RadialGroup(Context *context) 
     : BorderImage(context)
+    , selectedIdx_(-1)
+    , firstItem_(0)
+    , virtualMode_(false)
 {
     SetLayoutMode(LM_VERTICAL);
     SetLayoutBorder(IntRect(4,4,4,4));
@@ -84,10 +95,10 @@ RadialElement* RadialGroup::CreateRadialButton()
 {
     RadialElement radElem;
 
-    UIElement *element = bodyElement_->CreateChild<UIElement>();
+    UIElement *element = (rowsElement_ ? rowsElement_ : bodyElement_)->CreateChild<UIElement>();
     radElem.bodyElement_ = element;
     element->SetLayoutBorder(IntRect(10,4,4,4));
-    element->SetFocusMode(FM_FOCUSABLE_DEFOCUSABLE);
+    element->SetFocusMode(virtualMode_ ? FM_NOTFOCUSABLE : FM_FOCUSABLE_DEFOCUSABLE);
     element->SetLayoutMode(LM_HORIZONTAL);
     element->SetLayoutSpacing(10);
     element->SetMaxHeight(25);
@@ -96,8 +107,16 @@ RadialElement* RadialGroup::CreateRadialButton()
     radElem.checkbox_->SetStyleAuto();
     radElem.checkbox_->SetImageRect(IntRect(208, 96, 224, 112));
     radElem.checkbox_->SetChecked(childList_.Size() == 0);
+    radElem.checkbox_->SetVar(VAR_RADIAL_ITEM, (int)childList_.Size());
 
     radElem.textDesc_ = element->CreateChild<RadialText>();
+    radElem.textDesc_->SetVar(VAR_RADIAL_ITEM, (int)childList_.Size());
+
+    if ( childList_.Size() == 0 )
+    {
+        selectedIdx_ = 0;
+    }
+
     childList_.Push(radElem);
 
     return &childList_.Back();
@@ -115,6 +134,152 @@ RadialElement* RadialGroup::GetRadialButtonDesc(unsigned idx)
     return desc;
 }
 
+void RadialGroup::SetVirtualItems(const Vector<String> &labels, unsigned visibleRows)
+{
+    bodyElement_->RemoveAllChildren();
+    childList_.Clear();
+
+    virtualMode_ = true;
+    itemLabels_ = labels;
+    firstItem_ = 0;
+    selectedIdx_ = -1;
+
+    // rows on the left, scrollbar on the right
+    UIElement *container = bodyElement_->CreateChild<UIElement>();
+    container->SetLayoutMode(LM_HORIZONTAL);
+
+    rowsElement_ = container->CreateChild<UIElement>();
+    rowsElement_->SetLayoutMode(LM_VERTICAL);
+
+    scrollBar_ = container->CreateChild<ScrollBar>();
+    scrollBar_->SetStyleAuto();
+    scrollBar_->SetOrientation(O_VERTICAL);
+    scrollBar_->SetFixedWidth(12);
+    SubscribeToEvent(scrollBar_, E_SCROLLBARCHANGED, URHO3D_HANDLER(RadialGroup, HandleScrollBarChanged));
+
+    // neither the rows nor the group take focus, the ui's focused wheel routing never reaches us
+    SubscribeToEvent(E_MOUSEWHEEL, URHO3D_HANDLER(RadialGroup, HandleMouseWheel));
+
+    unsigned numRows = Min(visibleRows, labels.Size());
+
+    for ( unsigned i = 0; i < numRows; ++i )
+    {
+        CreateRadialButton();
+    }
+
+    // the pool creation selects row 0, nothing is selected until clicked
+    selectedIdx_ = -1;
+
+    unsigned range = labels.Size() - numRows;
+    scrollBar_->SetRange((float)range);
+    scrollBar_->SetVisible(range > 0);
+
+    UpdateVirtualRows();
+}
+
+void RadialGroup::SetFirstVisibleItem(unsigned idx)
+{
+    if ( !virtualMode_ )
+        return;
+
+    idx = Min(idx, itemLabels_.Size() - childList_.Size());
+
+    if ( idx == firstItem_ )
+        return;
+
+    firstItem_ = idx;
+
+    if ( scrollBar_ && (unsigned)(scrollBar_->GetValue() + 0.5f) != firstItem_ )
+    {
+        scrollBar_->SetValue((float)firstItem_);
+    }
+
+    UpdateVirtualRows();
+}
+
+void RadialGroup::UpdateVirtualRows()
+{
+    // rows are rebound to the items under the viewport, the widgets stay
+    for ( unsigned i = 0; i < childList_.Size(); ++i )
+    {
+        RadialElement &row = childList_[i];
+        int item = (int)(firstItem_ + i);
+
+        row.checkbox_->SetVar(VAR_RADIAL_ITEM, item);
+        row.checkbox_->SetCheckedInternal(item == selectedIdx_);
+        row.textDesc_->SetVar(VAR_RADIAL_ITEM, item);
+        row.textDesc_->SetText(itemLabels_[item]);
+    }
+}
+
+RadialElement* RadialGroup::GetItemRow(int idx)
+{
+    if ( idx < 0 )
+        return NULL;
+
+    if ( virtualMode_ )
+        idx -= (int)firstItem_;
+
+    return (idx >= 0 && idx < (int)childList_.Size()) ? &childList_[idx] : NULL;
+}
+
+void RadialGroup::SetSelectedIndex(int idx)
+{
+    RadialElement *row = GetItemRow(selectedIdx_);
+
+    if ( row )
+    {
+        row->checkbox_->SetCheckedInternal(false);
+    }
+
+    selectedIdx_ = (idx >= 0 && idx < (int)GetNumItems()) ? idx : -1;
+    row = GetItemRow(selectedIdx_);
+
+    if ( row )
+    {
+        row->checkbox_->SetCheckedInternal(true);
+    }
+}
+
+void RadialGroup::OnWheel(int delta, int buttons, int qualifiers)
+{
+    if ( !virtualMode_ )
+        return;
+
+    int first = (int)firstItem_ - delta;
+    SetFirstVisibleItem((unsigned)Max(first, 0));
+}
+
+void RadialGroup::HandleMouseWheel(StringHash eventType, VariantMap& eventData)
+{
+    using namespace MouseWheel;
+
+    UI *ui = GetSubsystem<UI>();
+
+    // in non-focused mode the ui already calls OnWheel on the wheel handler
+    if ( ui->IsNonFocusedMouseWheel() || !IsVisibleEffective() )
+        return;
+
+    UIElement *element = ui->GetElementAt(ui->GetCursorPosition());
+
+    while ( element && element != this )
+    {
+        element = element->GetParent();
+    }
+
+    if ( element )
+    {
+        OnWheel(eventData[P_WHEEL].GetInt(), eventData[P_BUTTONS].GetInt(), eventData[P_QUALIFIERS].GetInt());
+    }
+}
+
+void RadialGroup::HandleScrollBarChanged(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ScrollBarChanged;
+
+    SetFirstVisibleItem((unsigned)(eventData[P_VALUE].GetFloat() + 0.5f));
+}
+
 Text* RadialGroup::GetTitleTextElement() 
 {
     return headerText_; 
@@ -164,21 +329,14 @@ void RadialGroup::HandlePressed(StringHash eventType, VariantMap& eventData)
 {
     using namespace Pressed;
     UIElement *element = (UIElement*)eventData[P_ELEMENT].GetVoidPtr();
-    int selectedIdx = -1;
+    int idx = element->GetVar(VAR_RADIAL_ITEM).GetInt();
+    bool changed = idx != selectedIdx_;
 
-    for ( int i = 0; i < (int)childList_.Size(); ++i )
-    {
-        CheckBox *chkbox = childList_[i].checkbox_;
+    SetSelectedIndex(idx);
 
-        if (childList_[i].textDesc_ == element && !chkbox->IsChecked())
-            selectedIdx = i;
-
-        chkbox->SetCheckedInternal(childList_[i].textDesc_ == element);
-    }
-
-    if (selectedIdx >= 0)
+    if (changed)
     {
-        SendGroupToggleEvent(selectedIdx);
+        SendGroupToggleEvent(idx);
     }
 }
 
@@ -187,23 +345,13 @@ void RadialGroup::HandleCheckbox(StringHash eventType, VariantMap& eventData)
     using namespace Toggled;
 
     CheckBox *element = (CheckBox*)eventData[P_ELEMENT].GetVoidPtr();
-    bool checked = eventData[P_STATE].GetBool();
-    int checkedIdx = -1;
-
-    for ( int i = 0; i < (int)childList_.Size(); ++i )
-    {
-        CheckBox *chkbox = childList_[i].checkbox_;
-
-        if (chkbox == element)
-            checkedIdx = i;
+    int idx = element->GetVar(VAR_RADIAL_ITEM).GetInt();
 
-        chkbox->SetCheckedInternal(chkbox == element);
-    }
+    // a click on the checked box unchecks it, SetSelectedIndex puts it back
+    SetSelectedIndex(idx);
+    element->SetCheckedInternal(true);
 
-    if (checkedIdx >= 0)
-    {
-        SendGroupToggleEvent(checkedIdx);
-    }
+    SendGroupToggleEvent(idx);
 }
 
 void RadialGroup::SendGroupToggleEvent(int idx)
@@ -26,6 +26,7 @@
 namespace Urho3D
 {
 class Text;
+class ScrollBar;
 }
 using namespace Urho3D;
 //=============================================================================
@@ -73,6 +74,17 @@ public:
     RadialElement* CreateRadialButton();
     RadialElement* GetRadialButtonDesc(unsigned idx);
 
+    // virtualized mode: only visibleRows widgets are created and recycled while
+    // scrolling, GetRadialButtonDesc() then returns the pooled rows
+    void SetVirtualItems(const Vector<String> &labels, unsigned visibleRows);
+    bool IsVirtual() const { return virtualMode_; }
+    unsigned GetNumItems() const { return virtualMode_ ? itemLabels_.Size() : childList_.Size(); }
+    void SetFirstVisibleItem(unsigned idx);
+    unsigned GetFirstVisibleItem() const { return firstItem_; }
+
+    void SetSelectedIndex(int idx);
+    int GetSelectedIndex() const { return selectedIdx_; }
+
     UIElement* GetHeaderElement() { return headerElement_; }
     UIElement* GetBodyElement()   { return bodyElement_;   }
     Text* GetTitleTextElement();
@@ -84,10 +96,18 @@ public:
     bool SetHeaderFontSize(int size);
     void SetHeaderText(const String& text);
 
+    // virtual override
+    virtual void OnWheel(int delta, int buttons, int qualifiers);
+    virtual bool IsWheelHandler() const { return virtualMode_; }
+
 protected:
     void HandleCheckbox(StringHash eventType, VariantMap& eventData);
     void HandlePressed(StringHash eventType, VariantMap& eventData);
+    void HandleScrollBarChanged(StringHash eventType, VariantMap& eventData);
+    void HandleMouseWheel(StringHash eventType, VariantMap& eventData);
     void SendGroupToggleEvent(int idx);
+    RadialElement* GetItemRow(int idx);
+    void UpdateVirtualRows();
 
 protected:
     WeakPtr<UIElement> headerElement_;
@@ -96,6 +116,14 @@ protected:
 
     Vector<RadialElement> childList_;
     IntVector2         internalSize_; 
+    int                selectedIdx_;
+
+    // virtualized mode
+    WeakPtr<UIElement> rowsElement_;
+    WeakPtr<ScrollBar> scrollBar_;
+    Vector<String>     itemLabels_;
+    unsigned           firstItem_;
+    bool               virtualMode_;
 };
 
 
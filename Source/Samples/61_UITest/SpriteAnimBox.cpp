@@ -34,21 +34,35 @@
 #include <Urho3D/Resource/XMLElement.h>
 
 #include "SpriteAnimBox.h"
+#include "SpriteAtlas.h"
+#include "SpriteAnimManager.h"
 
 #include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define DEFAULT_STREAM_TEXTURE_BUDGET   (8 * 1024 * 1024)
+
 //=============================================================================
 //=============================================================================
 void SpriteAnimBox::RegisterObject(Context* context)
 {
     context->RegisterFactory<SpriteAnimBox>();
+    SpriteAtlas::RegisterObject(context);
+    SpriteAnimManager::RegisterObject(context);
 }
 
 SpriteAnimBox::SpriteAnimBox(Context *context)
     : BorderImage(context)
     , spriteIndex_(0)
-    , elapsedTime_(0)
-    , frameMsec_(30)
+    , frameTime_(0.03f)
+    , animatorIndex_(INVALID_ANIMATOR_INDEX)
+    , animEnabled_(false)
     , paused_(true)
+    , textureBudget_(DEFAULT_STREAM_TEXTURE_BUDGET)
+    , prefetchTime_(0.5f)
+    , framesBehind_(1)
+    , framesAhead_(0)
+    , streaming_(false)
 {
     SetLayoutMode(LM_VERTICAL);
 
@@ -71,6 +85,13 @@ SpriteAnimBox::SpriteAnimBox(Context *context)
 
 SpriteAnimBox::~SpriteAnimBox()
 {
+    // the manager holds a raw pointer
+    SpriteAnimManager *animManager = GetSubsystem<SpriteAnimManager>();
+
+    if ( animManager )
+    {
+        animManager->Remove(this);
+    }
 }
 
 void SpriteAnimBox::Create(IntVector2 &size, bool showHeader, bool showControl)
@@ -126,64 +147,297 @@ void SpriteAnimBox::SetHeaderText(const String& text)
     headerText_->SetText(text);
 }
 
-void SpriteAnimBox::AddSprite(const String& spriteFile)
+bool SpriteAnimBox::AddSprite(const String& spriteFile)
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    if ( streaming_ )
+    {
+        // only the first frame is loaded up front, it sizes the body
+        if ( spriteList_.Size() == 0 )
+        {
+            Texture2D *tex2d = cache->GetResource<Texture2D>(spriteFile);
+
+            if ( tex2d == NULL )
+                return false;
+
+            frameFiles_.Push(spriteFile);
+            AddFrame(SpriteFrame(NULL, IntRect(0, 0, tex2d->GetWidth(), tex2d->GetHeight())));
+        }
+        else
+        {
+            frameFiles_.Push(spriteFile);
+            AddFrame(SpriteFrame(NULL, IntRect::ZERO));
+        }
+        return true;
+    }
+
     Texture2D *tex2d = cache->GetResource<Texture2D>(spriteFile);
-    spriteList_.Push(tex2d);
+
+    if ( tex2d == NULL )
+        return false;
+
+    AddFrame(SpriteFrame(tex2d, IntRect(0, 0, tex2d->GetWidth(), tex2d->GetHeight())));
+
+    return true;
+}
+
+bool SpriteAnimBox::AddSpriteSheet(const String& sheetFile, const IntVector2 &frameSize, int numFrames)
+{
+    // atlas frames have no file to stream from
+    if ( streaming_ )
+        return false;
+
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Texture2D *tex2d = cache->GetResource<Texture2D>(sheetFile);
+    SharedPtr<SpriteAtlas> atlas(new SpriteAtlas(context_));
+
+    if ( !atlas->SetSpriteSheet(tex2d, frameSize, numFrames) )
+        return false;
+
+    for ( unsigned i = 0; i < atlas->GetNumFrames(); ++i )
+    {
+        AddFrame(SpriteFrame(tex2d, atlas->GetFrameRect(i)));
+    }
+
+    return true;
+}
+
+bool SpriteAnimBox::AddPackedSprites(const Vector<String>& spriteFiles, const String& atlasName)
+{
+    if ( streaming_ )
+        return false;
+
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    SpriteAtlas *atlas = cache->GetExistingResource<SpriteAtlas>(atlasName);
+
+    // pack once, other boxes pick it up from the cache
+    if ( atlas == NULL )
+    {
+        SharedPtr<SpriteAtlas> newAtlas(new SpriteAtlas(context_));
+
+        if ( !newAtlas->Pack(spriteFiles) )
+            return false;
+
+        newAtlas->SetName(atlasName);
+        cache->AddManualResource(newAtlas);
+        atlas = newAtlas;
+    }
+
+    for ( unsigned i = 0; i < atlas->GetNumFrames(); ++i )
+    {
+        AddFrame(SpriteFrame(atlas->GetTexture(), atlas->GetFrameRect(i)));
+    }
+
+    return true;
+}
+
+bool SpriteAnimBox::SetStreaming(bool enable)
+{
+    // every frame of a streamed box needs its file in frameFiles_
+    if ( spriteList_.Size() && enable != streaming_ )
+        return false;
+
+    streaming_ = enable;
+    return true;
+}
+
+void SpriteAnimBox::AddFrame(const SpriteFrame &frame)
+{
+    spriteList_.Push(frame);
 
     if (spriteList_.Size() == 1)
     {
-        bodyElement_->SetMaxSize(tex2d->GetWidth(), tex2d->GetHeight());
-		bodyElement_->SetTexture(spriteList_[0]);
+        bodyElement_->SetMaxSize(frame.rect_.Width(), frame.rect_.Height());
+        SetFrame(0);
+    }
+
+    // frame count changed
+    if ( animatorIndex_ != INVALID_ANIMATOR_INDEX )
+    {
+        GetSubsystem<SpriteAnimManager>()->Remove(this);
+        UpdateAnimator();
+    }
+}
+
+void SpriteAnimBox::SetFrame(int index)
+{
+    SpriteFrame frame = spriteList_[index];
+    spriteIndex_ = index;
+
+    if ( streaming_ )
+    {
+        assert(frameFiles_.Size() == spriteList_.Size());
+        UpdateStreamWindow();
+
+        // streamed frames are never held by pointer, they can be released
+        frame.texture_ = GetSubsystem<ResourceCache>()->GetExistingResource<Texture2D>(frameFiles_[index]);
+
+        // not loaded yet, keep showing the last frame
+        if ( frame.texture_ == NULL )
+            return;
+    }
+
+    // same atlas: only the rect changes
+    if ( bodyElement_->GetTexture() != frame.texture_ )
+    {
+        bodyElement_->SetTexture(frame.texture_);
+    }
+
+    if ( frame.rect_ != IntRect::ZERO )
+        bodyElement_->SetImageRect(frame.rect_);
+    else
+        bodyElement_->SetFullImageRect();
+}
+
+void SpriteAnimBox::UpdateStreamWindow()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    unsigned numFrames = frameFiles_.Size();
+
+    // prefetch what plays in the next prefetchTime_ seconds
+    framesAhead_ = Clamp(CeilToInt(prefetchTime_ / frameTime_), 1, (int)numFrames - 1);
+
+    for ( int i = -framesBehind_; i <= framesAhead_; ++i )
+    {
+        unsigned idx = (unsigned)((spriteIndex_ + i + (int)numFrames) % (int)numFrames);
+        const String &file = frameFiles_[idx];
+
+        if ( !residentFrames_.Contains(idx) )
+        {
+            residentFrames_.Push(idx);
+        }
+
+        if ( cache->GetExistingResource<Texture2D>(file) == NULL )
+        {
+            cache->BackgroundLoadResource<Texture2D>(file);
+        }
+    }
+
+    // release frames outside of the window while over the budget, farthest first
+    unsigned residentBytes = 0;
+
+    for ( unsigned i = 0; i < residentFrames_.Size(); ++i )
+    {
+        Texture2D *tex2d = cache->GetExistingResource<Texture2D>(frameFiles_[residentFrames_[i]]);
+        residentBytes += tex2d ? tex2d->GetMemoryUse() : 0;
+    }
+
+    while ( residentBytes > textureBudget_ )
+    {
+        int farthest = -1;
+        unsigned farthestDist = 0;
+
+        for ( unsigned i = 0; i < residentFrames_.Size(); ++i )
+        {
+            unsigned dist = (residentFrames_[i] + numFrames - (unsigned)spriteIndex_) % numFrames;
+
+            if ( !InsideStreamWindow(residentFrames_[i]) && dist > farthestDist )
+            {
+                farthest = (int)i;
+                farthestDist = dist;
+            }
+        }
+
+        if ( farthest == -1 )
+            break;
+
+        const String &file = frameFiles_[residentFrames_[farthest]];
+        Texture2D *tex2d = cache->GetExistingResource<Texture2D>(file);
+
+        if ( tex2d )
+        {
+            residentBytes -= tex2d->GetMemoryUse();
+            cache->ReleaseResource(Texture2D::GetTypeStatic(), file);
+        }
+
+        residentFrames_.Erase(farthest);
+    }
+}
+
+bool SpriteAnimBox::InsideStreamWindow(unsigned idx) const
+{
+    unsigned numFrames = frameFiles_.Size();
+    unsigned dist = (idx + numFrames - (unsigned)spriteIndex_) % numFrames;
+
+    return dist <= (unsigned)framesAhead_ || dist >= numFrames - (unsigned)framesBehind_;
+}
+
+void SpriteAnimBox::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor)
+{
+    // a transparent background would still emit an untextured quad and break
+    // the merge between the bodies of neighbouring boxes
+    if ( color_[C_TOPLEFT].a_ == 0.0f && color_[C_TOPRIGHT].a_ == 0.0f &&
+         color_[C_BOTTOMLEFT].a_ == 0.0f && color_[C_BOTTOMRIGHT].a_ == 0.0f )
+        return;
+
+    BorderImage::GetBatches(batches, vertexData, currentScissor);
+}
+
+void SpriteAnimBox::SetFPS(float fps)
+{
+    assert(fps >= 1.0f);
+    frameTime_ = 1.0f/fps;
+
+    if ( animatorIndex_ != INVALID_ANIMATOR_INDEX )
+    {
+        GetSubsystem<SpriteAnimManager>()->Remove(this);
+        UpdateAnimator();
     }
 }
 
 void SpriteAnimBox::SetEnabled(bool enable)
 {
-    elapsedTime_ = 0;
-    spriteIndex_ = 0;
+    animEnabled_ = enable;
+
+    // restart from the first frame
+    GetSubsystem<SpriteAnimManager>()->Remove(this);
+
+    if ( spriteList_.Size() )
+    {
+        SetFrame(0);
+    }
 
     if ( enable )
     {
-        SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(SpriteAnimBox, HandleUpdate));
         SubscribeToEvent(playButton_, E_TOGGLED, URHO3D_HANDLER(SpriteAnimBox, HandleCheckbox));
     }
     else
     {
-        UnsubscribeFromEvent(E_UPDATE);
         UnsubscribeFromEvent(playButton_, E_TOGGLED);
     }
+
+    UpdateAnimator();
 }
 
 void SpriteAnimBox::Play()
 {
     paused_ = false;
+    UpdateAnimator();
 }
 
 void SpriteAnimBox::Pause()
 {
     paused_ = true;
+    UpdateAnimator();
 }
 
 void SpriteAnimBox::Quit()
 {
-    UnsubscribeFromEvent(E_UPDATE);
+    animEnabled_ = false;
     UnsubscribeFromEvent(playButton_, E_TOGGLED);
+    UpdateAnimator();
 }
 
-void SpriteAnimBox::HandleUpdate(StringHash eventType, VariantMap& eventData)
+void SpriteAnimBox::UpdateAnimator()
 {
-    using namespace Update;
-
-    elapsedTime_ += (int)(eventData[P_TIMESTEP].GetFloat() * 1000.0f);
+    // only playing boxes are ticked
+    SpriteAnimManager *animManager = GetSubsystem<SpriteAnimManager>();
 
-    if ( !paused_ && elapsedTime_ >= frameMsec_ )
-    {
-        elapsedTime_ = 0;
-		spriteIndex_ = ++spriteIndex_ % spriteList_.Size();
-		bodyElement_->SetTexture(spriteList_[spriteIndex_]);
-    }
+    if ( animEnabled_ && !paused_ )
+        animManager->Add(this);
+    else
+        animManager->Remove(this);
 }
 
 void SpriteAnimBox::HandleCheckbox(StringHash eventType, VariantMap& eventData)
@@ -27,14 +27,30 @@ namespace Urho3D
 class Text;
 class BorderImage;
 class CheckBox;
+class Texture2D;
 }
 
 using namespace Urho3D;
 //=============================================================================
 //=============================================================================
+struct SpriteFrame
+{
+    SpriteFrame() : texture_(NULL), rect_(IntRect::ZERO) {}
+    SpriteFrame(Texture2D *texture, const IntRect &rect) : texture_(texture), rect_(rect) {}
+
+    Texture2D *texture_;
+    IntRect    rect_;
+};
+
+//=============================================================================
+// frames from an atlas (sprite sheet or packed at load time) share a texture
+// and only change the image rect, boxes with the header and control hidden
+// then batch with each other
+//=============================================================================
 class SpriteAnimBox : public BorderImage
 {
     URHO3D_OBJECT(SpriteAnimBox, UIElement);
+    friend class SpriteAnimManager;
 public:
     static void RegisterObject(Context* context);
 
@@ -49,21 +65,47 @@ public:
     void ShowControl(bool show);
 
     void Create(IntVector2 &size, bool showHeader=false, bool showControl=false);
-    void AddSprite(const String& spriteFile);
-    void SetFPS(float fps) { assert(fps >= 1.0f); frameMsec_ = (int)(1000.0f/fps); }
+    bool AddSprite(const String& spriteFile);
+    bool AddSpriteSheet(const String& sheetFile, const IntVector2 &frameSize, int numFrames = 0);
+    bool AddPackedSprites(const Vector<String>& spriteFiles, const String& atlasName);
+    void SetFPS(float fps);
     void SetEnabled(bool enable);
     void Play();
     void Pause();
     void Quit();
 
+    // streaming: AddSprite() only loads the first frame, the rest are
+    // background loaded around the playhead and released over the budget.
+    // set before adding frames, a box is either all streamed or all resident
+    bool SetStreaming(bool enable);
+    void SetTextureBudget(unsigned bytes)   { textureBudget_ = bytes; }
+    void SetPrefetchTime(float seconds)     { prefetchTime_ = seconds; }
+    bool IsStreaming() const                { return streaming_; }
+
+    int GetFrameIndex() const           { return spriteIndex_; }
+    unsigned GetNumFrames() const       { return spriteList_.Size(); }
+    float GetFrameTime() const          { return frameTime_; }
+
+    // SpriteAnimManager slot
+    void SetAnimatorIndex(unsigned idx) { animatorIndex_ = idx; }
+    unsigned GetAnimatorIndex() const   { return animatorIndex_; }
+
     bool SetHeaderFont(const String& fontName, int size = DEFAULT_FONT_SIZE);
     bool SetHeaderFont(Font* font, int size = DEFAULT_FONT_SIZE);
     bool SetHeaderFontSize(int size);
     void SetHeaderText(const String& text);
 
+    // virtual override
+    virtual void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor);
+
 protected:
     void SetDefaultPlayButton();
-    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void AddFrame(const SpriteFrame &frame);
+    // the manager owns the playhead while the box is playing
+    void SetFrame(int index);
+    void UpdateAnimator();
+    void UpdateStreamWindow();
+    bool InsideStreamWindow(unsigned idx) const;
     void HandleCheckbox(StringHash eventType, VariantMap& eventData);
 
 protected:
@@ -73,10 +115,19 @@ protected:
     WeakPtr<Text>        headerText_;
     WeakPtr<CheckBox>    playButton_;
 
-    Vector<Texture2D*>   spriteList_;
+    PODVector<SpriteFrame> spriteList_;
     int                  spriteIndex_;
-    int                  elapsedTime_;
-    int                  frameMsec_;
+    float                frameTime_;
+    unsigned             animatorIndex_;
+    bool                 animEnabled_;
     bool                 paused_;
+
+    Vector<String>       frameFiles_;
+    PODVector<unsigned>  residentFrames_;
+    unsigned             textureBudget_;
+    float                prefetchTime_;
+    int                  framesBehind_;
+    int                  framesAhead_;
+    bool                 streaming_;
 };
 
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+
+#include "SpriteAnimManager.h"
+#include "SpriteAnimBox.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+void SpriteAnimManager::RegisterObject(Context* context)
+{
+    context->RegisterSubsystem( new SpriteAnimManager(context) );
+}
+
+SpriteAnimManager::SpriteAnimManager(Context *context)
+    : Object(context)
+{
+}
+
+SpriteAnimManager::~SpriteAnimManager()
+{
+}
+
+bool SpriteAnimManager::Add(SpriteAnimBox *animBox)
+{
+    if ( animBox->GetAnimatorIndex() != INVALID_ANIMATOR_INDEX || animBox->GetNumFrames() < 2 )
+        return false;
+
+    SpriteAnimator animator;
+    animator.box_         = animBox;
+    animator.accumulator_ = 0.0f;
+    animator.frameTime_   = animBox->GetFrameTime();
+    animator.frameIndex_  = animBox->GetFrameIndex();
+    animator.numFrames_   = (int)animBox->GetNumFrames();
+
+    animBox->SetAnimatorIndex(animatorList_.Size());
+    animatorList_.Push(animator);
+
+    if ( animatorList_.Size() == 1 )
+    {
+        SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(SpriteAnimManager, HandleUpdate));
+    }
+
+    return true;
+}
+
+bool SpriteAnimManager::Remove(SpriteAnimBox *animBox)
+{
+    unsigned idx = animBox->GetAnimatorIndex();
+
+    if ( idx >= animatorList_.Size() || animatorList_[idx].box_ != animBox )
+        return false;
+
+    // swap with the last entry to keep the array packed
+    animatorList_[idx] = animatorList_.Back();
+    animatorList_[idx].box_->SetAnimatorIndex(idx);
+    animatorList_.Pop();
+    animBox->SetAnimatorIndex(INVALID_ANIMATOR_INDEX);
+
+    if ( animatorList_.Size() == 0 )
+    {
+        UnsubscribeFromEvent(E_UPDATE);
+    }
+
+    return true;
+}
+
+void SpriteAnimManager::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace Update;
+
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+
+    for ( unsigned i = 0; i < animatorList_.Size(); ++i )
+    {
+        SpriteAnimator &animator = animatorList_[i];
+
+        if ( !animator.box_->IsVisibleEffective() )
+            continue;
+
+        animator.accumulator_ += timeStep;
+
+        if ( animator.accumulator_ < animator.frameTime_ )
+            continue;
+
+        // keep the remainder so playback doesn't drift, skip frames on a long step
+        int steps = (int)(animator.accumulator_ / animator.frameTime_);
+        animator.accumulator_ -= (float)steps * animator.frameTime_;
+        animator.frameIndex_ = (animator.frameIndex_ + steps) % animator.numFrames_;
+
+        animator.box_->SetFrame(animator.frameIndex_);
+    }
+}
+
@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/Core/Object.h>
+
+class SpriteAnimBox;
+
+using namespace Urho3D;
+//=============================================================================
+//=============================================================================
+#define INVALID_ANIMATOR_INDEX  M_MAX_UNSIGNED
+
+struct SpriteAnimator
+{
+    SpriteAnimBox *box_;
+    float          accumulator_;
+    float          frameTime_;
+    int            frameIndex_;
+    int            numFrames_;
+};
+
+//=============================================================================
+// single clock for every playing SpriteAnimBox: one update walks a packed
+// array, paused boxes are swapped out of it and invisible ones are skipped
+//=============================================================================
+class SpriteAnimManager : public Object
+{
+    URHO3D_OBJECT(SpriteAnimManager, Object);
+public:
+    static void RegisterObject(Context* context);
+
+    SpriteAnimManager(Context *context);
+    virtual ~SpriteAnimManager();
+
+    bool Add(SpriteAnimBox *animBox);
+    bool Remove(SpriteAnimBox *animBox);
+    unsigned GetNumAnimators() const { return animatorList_.Size(); }
+
+protected:
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+
+protected:
+    PODVector<SpriteAnimator> animatorList_;
+};
+
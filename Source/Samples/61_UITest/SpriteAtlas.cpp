@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/Math/AreaAllocator.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/IO/Log.h>
+
+#include "SpriteAtlas.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define ATLAS_FRAME_PADDING     1
+
+//=============================================================================
+//=============================================================================
+void SpriteAtlas::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SpriteAtlas>();
+}
+
+SpriteAtlas::SpriteAtlas(Context *context)
+    : Resource(context)
+{
+}
+
+SpriteAtlas::~SpriteAtlas()
+{
+}
+
+bool SpriteAtlas::Pack(const Vector<String> &imageFiles, int maxSize)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Vector<SharedPtr<Image> > images;
+    AreaAllocator allocator(128, 128, maxSize, maxSize);
+
+    frameRects_.Clear();
+
+    // allocate first, the allocator may still grow
+    for ( unsigned i = 0; i < imageFiles.Size(); ++i )
+    {
+        // temp resources, the source frames aren't kept once they're in the atlas
+        SharedPtr<Image> image = cache->GetTempResource<Image>(imageFiles[i]);
+        int x, y;
+
+        if ( image == NULL )
+            return false;
+
+        if ( !allocator.Allocate(image->GetWidth() + ATLAS_FRAME_PADDING, image->GetHeight() + ATLAS_FRAME_PADDING, x, y) )
+        {
+            URHO3D_LOGERRORF("SpriteAtlas: %s doesn't fit in a %dx%d atlas", imageFiles[i].CString(), maxSize, maxSize);
+            return false;
+        }
+
+        images.Push(image);
+        frameRects_.Push(IntRect(x, y, x + image->GetWidth(), y + image->GetHeight()));
+    }
+
+    SharedPtr<Image> atlasImage(new Image(context_));
+    atlasImage->SetSize(allocator.GetWidth(), allocator.GetHeight(), 4);
+    atlasImage->Clear(Color::TRANSPARENT);
+
+    for ( unsigned i = 0; i < images.Size(); ++i )
+    {
+        Image *image = images[i];
+        const IntRect &rect = frameRects_[i];
+
+        if ( image->GetComponents() == 4 )
+        {
+            for ( int y = 0; y < image->GetHeight(); ++y )
+            {
+                memcpy(atlasImage->GetData() + ((rect.top_ + y) * atlasImage->GetWidth() + rect.left_) * 4,
+                       image->GetData() + y * image->GetWidth() * 4, image->GetWidth() * 4);
+            }
+        }
+        else
+        {
+            for ( int y = 0; y < image->GetHeight(); ++y )
+            {
+                for ( int x = 0; x < image->GetWidth(); ++x )
+                {
+                    atlasImage->SetPixel(rect.left_ + x, rect.top_ + y, image->GetPixel(x, y));
+                }
+            }
+        }
+    }
+
+    texture_ = new Texture2D(context_);
+    texture_->SetNumLevels(1);
+
+    if ( !texture_->SetData(atlasImage, true) )
+        return false;
+
+    SetMemoryUse(sizeof(SpriteAtlas) + frameRects_.Size() * sizeof(IntRect) + atlasImage->GetWidth() * atlasImage->GetHeight() * 4);
+
+    return true;
+}
+
+bool SpriteAtlas::SetSpriteSheet(Texture2D *texture, const IntVector2 &frameSize, int numFrames)
+{
+    if ( texture == NULL || frameSize.x_ <= 0 || frameSize.y_ <= 0 )
+        return false;
+
+    texture_ = texture;
+    frameRects_.Clear();
+
+    int cols = texture->GetWidth() / frameSize.x_;
+    int rows = texture->GetHeight() / frameSize.y_;
+    int count = numFrames > 0 ? Min(numFrames, cols * rows) : cols * rows;
+
+    // row major
+    for ( int i = 0; i < count; ++i )
+    {
+        int x = (i % cols) * frameSize.x_;
+        int y = (i / cols) * frameSize.y_;
+
+        frameRects_.Push(IntRect(x, y, x + frameSize.x_, y + frameSize.y_));
+    }
+
+    return count > 0;
+}
+
@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/Resource/Resource.h>
+
+namespace Urho3D
+{
+class Texture2D;
+}
+
+using namespace Urho3D;
+//=============================================================================
+// frames packed into a single texture, added to the resource cache as a
+// manual resource so every box animating the same frames shares it
+//=============================================================================
+class SpriteAtlas : public Resource
+{
+    URHO3D_OBJECT(SpriteAtlas, Resource);
+public:
+    static void RegisterObject(Context* context);
+
+    SpriteAtlas(Context *context);
+    virtual ~SpriteAtlas();
+
+    bool Pack(const Vector<String> &imageFiles, int maxSize = 2048);
+    bool SetSpriteSheet(Texture2D *texture, const IntVector2 &frameSize, int numFrames = 0);
+
+    Texture2D* GetTexture() const                   { return texture_; }
+    unsigned GetNumFrames() const                   { return frameRects_.Size(); }
+    const IntRect& GetFrameRect(unsigned idx) const { return frameRects_[idx]; }
+
+protected:
+    SharedPtr<Texture2D> texture_;
+    PODVector<IntRect>   frameRects_;
+};
+
@@ -0,0 +1,379 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+
+#include "StrokeCanvas.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define INVALID_STROKE_ID   M_MAX_UNSIGNED
+
+//=============================================================================
+//=============================================================================
+void StrokeCanvas::RegisterObject(Context* context)
+{
+    context->RegisterFactory<StrokeCanvas>();
+}
+
+StrokeCanvas::StrokeCanvas(Context *context)
+    : UIElement(context)
+    , numStrokes_(0)
+    , gridDim_(IntVector2::ZERO)
+    , cellSize_(DEFAULT_CANVAS_CELL_SIZE)
+    , queryStamp_(0)
+{
+}
+
+StrokeCanvas::~StrokeCanvas()
+{
+}
+
+bool StrokeCanvas::Create(const IntVector2 &size, LineBatcher *tessellator, int cellSize)
+{
+    if ( tessellator == NULL || cellSize <= 0 )
+        return false;
+
+    tessellator_ = tessellator;
+    cellSize_ = cellSize;
+
+    gridDim_.x_ = Max((size.x_ + cellSize_ - 1) / cellSize_, 1);
+    gridDim_.y_ = Max((size.y_ + cellSize_ - 1) / cellSize_, 1);
+
+    Clear();
+    SetSize(size);
+
+    return true;
+}
+
+void StrokeCanvas::Clear()
+{
+    strokes_.Clear();
+    freeIds_.Clear();
+    numStrokes_ = 0;
+
+    gridCells_.Clear();
+    gridCells_.Resize(gridDim_.x_ * gridDim_.y_);
+}
+
+unsigned StrokeCanvas::AddStroke(const PODVector<IntVector2> &points, const StrokeBrush &brush)
+{
+    if ( tessellator_ == NULL || points.Size() < 2 )
+        return INVALID_STROKE_ID;
+
+    SharedPtr<CanvasStroke> stroke(new CanvasStroke());
+    stroke->points_ = points;
+    stroke->brush_ = brush;
+
+    // tessellate once, the stroke keeps its own copy of the geometry.
+    // the tessellator is the live line batcher, its brush is put back after
+    Color prevColor = tessellator_->GetColor(C_TOPLEFT);
+    float prevPixelSize = tessellator_->GetLinePixelSize();
+
+    tessellator_->SetLinePixelSize(brush.pixelSize_);
+    tessellator_->SetColor(brush.color_);
+    tessellator_->DrawPoints(points);
+    stroke->vertexData_ = tessellator_->GetVertexData();
+    stroke->batches_ = tessellator_->GetBatchList();
+    tessellator_->ClearPointList();
+    tessellator_->ClearBatchList();
+    tessellator_->SetLinePixelSize(prevPixelSize);
+    tessellator_->SetColor(prevColor);
+
+    // local space bounds, padded by the line width
+    IntVector2 screenPos = GetScreenPosition();
+    int pad = (int)ceilf(brush.pixelSize_) + 1;
+    IntRect bounds(M_MAX_INT, M_MAX_INT, -M_MAX_INT, -M_MAX_INT);
+
+    for ( unsigned i = 0; i < points.Size(); ++i )
+    {
+        IntVector2 pt = points[i] - screenPos;
+        bounds.left_   = Min(bounds.left_, pt.x_ - pad);
+        bounds.top_    = Min(bounds.top_, pt.y_ - pad);
+        bounds.right_  = Max(bounds.right_, pt.x_ + pad);
+        bounds.bottom_ = Max(bounds.bottom_, pt.y_ + pad);
+    }
+    stroke->bounds_ = bounds;
+
+    unsigned id;
+
+    if ( freeIds_.Size() )
+    {
+        id = freeIds_.Back();
+        freeIds_.Pop();
+        strokes_[id] = stroke;
+    }
+    else
+    {
+        id = strokes_.Size();
+        strokes_.Push(stroke);
+    }
+
+    InsertIntoGrid(id);
+    numStrokes_++;
+
+    return id;
+}
+
+bool StrokeCanvas::RemoveStroke(unsigned id)
+{
+    if ( id >= strokes_.Size() || strokes_[id] == NULL )
+        return false;
+
+    RemoveFromGrid(id);
+    strokes_[id].Reset();
+    freeIds_.Push(id);
+    numStrokes_--;
+
+    return true;
+}
+
+unsigned StrokeCanvas::Erase(const IntVector2 &center, float radius)
+{
+    IntVector2 localCenter = center - GetScreenPosition();
+    int r = (int)ceilf(radius);
+    IntRect query(localCenter.x_ - r, localCenter.y_ - r, localCenter.x_ + r, localCenter.y_ + r);
+    IntRect cells = GetCellRange(query);
+    Vector2 fcenter((float)center.x_, (float)center.y_);
+
+    PODVector<unsigned> hitList;
+
+    // gather candidates, each stroke is tested once even if it spans many cells
+    ++queryStamp_;
+
+    for ( int y = cells.top_; y <= cells.bottom_; ++y )
+    {
+        for ( int x = cells.left_; x <= cells.right_; ++x )
+        {
+            const PODVector<unsigned> &cell = gridCells_[y * gridDim_.x_ + x];
+
+            for ( unsigned i = 0; i < cell.Size(); ++i )
+            {
+                CanvasStroke *stroke = strokes_[cell[i]];
+
+                if ( stroke->queryStamp_ == queryStamp_ )
+                    continue;
+
+                stroke->queryStamp_ = queryStamp_;
+
+                const IntRect &bounds = stroke->bounds_;
+
+                if ( bounds.right_ < query.left_ || bounds.left_ > query.right_ ||
+                     bounds.bottom_ < query.top_ || bounds.top_ > query.bottom_ )
+                    continue;
+
+                if ( StrokeHit(stroke, fcenter, radius) )
+                {
+                    hitList.Push(cell[i]);
+                }
+            }
+        }
+    }
+
+    // remove or split only the intersecting strokes
+    Vector<PODVector<IntVector2> > pieces;
+
+    for ( unsigned i = 0; i < hitList.Size(); ++i )
+    {
+        SharedPtr<CanvasStroke> stroke = strokes_[hitList[i]];
+
+        pieces.Clear();
+        SplitStroke(stroke, fcenter, radius, pieces);
+        RemoveStroke(hitList[i]);
+
+        for ( unsigned j = 0; j < pieces.Size(); ++j )
+        {
+            AddStroke(pieces[j], stroke->brush_);
+        }
+    }
+
+    return hitList.Size();
+}
+
+int StrokeCanvas::GetBatchCount() const
+{
+    int count = 0;
+
+    for ( unsigned i = 0; i < strokes_.Size(); ++i )
+    {
+        if ( strokes_[i] )
+        {
+            count += (int)strokes_[i]->batches_.Size();
+        }
+    }
+
+    return count;
+}
+
+unsigned StrokeCanvas::GetVertexDataSize() const
+{
+    unsigned size = 0;
+
+    for ( unsigned i = 0; i < strokes_.Size(); ++i )
+    {
+        if ( strokes_[i] )
+        {
+            size += strokes_[i]->vertexData_.Size() * sizeof(float);
+        }
+    }
+
+    return size;
+}
+
+void StrokeCanvas::InsertIntoGrid(unsigned id)
+{
+    IntRect cells = GetCellRange(strokes_[id]->bounds_);
+
+    for ( int y = cells.top_; y <= cells.bottom_; ++y )
+    {
+        for ( int x = cells.left_; x <= cells.right_; ++x )
+        {
+            gridCells_[y * gridDim_.x_ + x].Push(id);
+        }
+    }
+}
+
+void StrokeCanvas::RemoveFromGrid(unsigned id)
+{
+    IntRect cells = GetCellRange(strokes_[id]->bounds_);
+
+    for ( int y = cells.top_; y <= cells.bottom_; ++y )
+    {
+        for ( int x = cells.left_; x <= cells.right_; ++x )
+        {
+            PODVector<unsigned> &cell = gridCells_[y * gridDim_.x_ + x];
+
+            for ( unsigned i = 0; i < cell.Size(); ++i )
+            {
+                if ( cell[i] == id )
+                {
+                    // order within a cell doesn't matter
+                    cell[i] = cell.Back();
+                    cell.Pop();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+IntRect StrokeCanvas::GetCellRange(const IntRect &rect) const
+{
+    // anything drawn outside of the canvas is clamped into the border cells
+    return IntRect(Clamp(rect.left_ / cellSize_, 0, gridDim_.x_ - 1),
+                   Clamp(rect.top_ / cellSize_, 0, gridDim_.y_ - 1),
+                   Clamp(rect.right_ / cellSize_, 0, gridDim_.x_ - 1),
+                   Clamp(rect.bottom_ / cellSize_, 0, gridDim_.y_ - 1));
+}
+
+bool StrokeCanvas::StrokeHit(const CanvasStroke *stroke, const Vector2 &center, float radius) const
+{
+    float r = radius + stroke->brush_.pixelSize_;
+    float rr = r * r;
+
+    for ( unsigned i = 1; i < stroke->points_.Size(); ++i )
+    {
+        if ( SegmentHit(stroke->points_[i - 1], stroke->points_[i], center, rr) )
+            return true;
+    }
+
+    return false;
+}
+
+bool StrokeCanvas::SegmentHit(const IntVector2 &p0, const IntVector2 &p1, const Vector2 &center, float radiusSquared) const
+{
+    Vector2 a((float)p0.x_, (float)p0.y_);
+    Vector2 b((float)p1.x_, (float)p1.y_);
+    Vector2 ab = b - a;
+    float lenSquared = ab.LengthSquared();
+    float t = lenSquared > M_EPSILON ? Clamp((center - a).DotProduct(ab) / lenSquared, 0.0f, 1.0f) : 0.0f;
+    Vector2 closest = a + ab * t;
+
+    return (center - closest).LengthSquared() <= radiusSquared;
+}
+
+void StrokeCanvas::SplitStroke(const CanvasStroke *stroke, const Vector2 &center, float radius, Vector<PODVector<IntVector2> > &pieces) const
+{
+    const PODVector<IntVector2> &points = stroke->points_;
+    float r = radius + stroke->brush_.pixelSize_;
+    float rr = r * r;
+    PODVector<IntVector2> piece;
+
+    piece.Push(points[0]);
+
+    // every segment touched by the eraser is dropped, the remaining runs become new strokes
+    for ( unsigned i = 1; i < points.Size(); ++i )
+    {
+        if ( SegmentHit(points[i - 1], points[i], center, rr) )
+        {
+            if ( piece.Size() > 1 )
+            {
+                pieces.Push(piece);
+            }
+            piece.Clear();
+        }
+        else if ( piece.Size() == 0 )
+        {
+            piece.Push(points[i - 1]);
+        }
+
+        if ( piece.Size() )
+        {
+            piece.Push(points[i]);
+        }
+    }
+
+    if ( piece.Size() > 1 )
+    {
+        pieces.Push(piece);
+    }
+}
+
+void StrokeCanvas::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor)
+{
+    for ( unsigned s = 0; s < strokes_.Size(); ++s )
+    {
+        CanvasStroke *stroke = strokes_[s];
+
+        if ( stroke == NULL )
+            continue;
+
+        for ( unsigned i = 0; i < stroke->batches_.Size(); ++i )
+        {
+            UIBatch &batch     = stroke->batches_[ i ];
+            unsigned beg       = batch.vertexStart_;
+            unsigned end       = batch.vertexEnd_;
+            batch.vertexStart_ = vertexData.Size();
+            batch.vertexEnd_   = vertexData.Size() + (end - beg);
+
+            vertexData.Resize( batch.vertexEnd_ );
+            memcpy( &vertexData[ batch.vertexStart_ ], &stroke->vertexData_[ beg ], (end - beg) * sizeof(float) );
+
+            UIBatch::AddOrMerge( batch, batches );
+
+            // restore
+            batch.vertexStart_ = beg;
+            batch.vertexEnd_   = end;
+        }
+    }
+}
+
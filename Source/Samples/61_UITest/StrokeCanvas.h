@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/UI/UIElement.h>
+
+#include "LineBatcher.h"
+#include "StrokeRecorder.h"
+
+using namespace Urho3D;
+//=============================================================================
+//=============================================================================
+#define DEFAULT_CANVAS_CELL_SIZE    64
+
+//=============================================================================
+// finished stroke: owns its geometry range, points are in screen space
+//=============================================================================
+struct CanvasStroke : public RefCounted
+{
+    CanvasStroke() : queryStamp_(0) {}
+
+    PODVector<IntVector2> points_;
+    PODVector<float>      vertexData_;
+    PODVector<UIBatch>    batches_;
+    StrokeBrush           brush_;
+    IntRect               bounds_;
+    unsigned              queryStamp_;
+};
+
+//=============================================================================
+// multi-stroke vector canvas, strokes are binned by bounding box into a
+// uniform grid so that erasing only visits the strokes near the eraser
+//=============================================================================
+class StrokeCanvas : public UIElement
+{
+    URHO3D_OBJECT(StrokeCanvas, UIElement);
+public:
+    static void RegisterObject(Context* context);
+
+    StrokeCanvas(Context *context);
+    virtual ~StrokeCanvas();
+
+    bool Create(const IntVector2 &size, LineBatcher *tessellator, int cellSize = DEFAULT_CANVAS_CELL_SIZE);
+    void Clear();
+
+    unsigned AddStroke(const PODVector<IntVector2> &points, const StrokeBrush &brush);
+    bool RemoveStroke(unsigned id);
+    unsigned Erase(const IntVector2 &center, float radius);
+
+    unsigned GetNumStrokes() const { return numStrokes_; }
+    int GetBatchCount() const;
+    unsigned GetVertexDataSize() const;
+
+    // virtual override
+    virtual void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor);
+
+protected:
+    void InsertIntoGrid(unsigned id);
+    void RemoveFromGrid(unsigned id);
+    IntRect GetCellRange(const IntRect &rect) const;
+    bool StrokeHit(const CanvasStroke *stroke, const Vector2 &center, float radius) const;
+    bool SegmentHit(const IntVector2 &p0, const IntVector2 &p1, const Vector2 &center, float radiusSquared) const;
+    void SplitStroke(const CanvasStroke *stroke, const Vector2 &center, float radius, Vector<PODVector<IntVector2> > &pieces) const;
+
+protected:
+    WeakPtr<LineBatcher>              tessellator_;
+
+    Vector<SharedPtr<CanvasStroke> >  strokes_;
+    PODVector<unsigned>               freeIds_;
+    unsigned                          numStrokes_;
+
+    Vector<PODVector<unsigned> >      gridCells_;
+    IntVector2                        gridDim_;
+    int                               cellSize_;
+    unsigned                          queryStamp_;
+};
+
@@ -0,0 +1,236 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/IO/Serializer.h>
+#include <Urho3D/IO/Deserializer.h>
+
+#include "StrokeRecorder.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define STROKE_FILE_ID          "STRK"
+#define STROKE_FILE_VERSION     1
+#define BRUSH_SIZE_SCALE        16.0f
+
+static inline unsigned ZigZagEncode(int val)
+{
+    return ((unsigned)val << 1) ^ (unsigned)(val >> 31);
+}
+
+static inline int ZigZagDecode(unsigned val)
+{
+    return (int)(val >> 1) ^ -(int)(val & 1);
+}
+
+static inline Color UIntToColor(unsigned val)
+{
+    // inverse of Color::ToUInt()
+    return Color((float)(val & 0xff) / 255.0f, (float)((val >> 8) & 0xff) / 255.0f,
+                 (float)((val >> 16) & 0xff) / 255.0f, (float)((val >> 24) & 0xff) / 255.0f);
+}
+
+//=============================================================================
+//=============================================================================
+StrokeRecorder::StrokeRecorder()
+    : lastStrokeTime_(0)
+    , timeOffset_(0)
+    , numStrokes_(0)
+    , recording_(false)
+{
+    WriteHeader();
+}
+
+void StrokeRecorder::Clear()
+{
+    buffer_.Clear();
+    strokePoints_.Clear();
+    strokeTimes_.Clear();
+    lastStrokeTime_ = 0;
+    timeOffset_ = 0;
+    numStrokes_ = 0;
+    recording_ = false;
+    timer_.Reset();
+
+    WriteHeader();
+}
+
+void StrokeRecorder::WriteHeader()
+{
+    buffer_.WriteFileID(STROKE_FILE_ID);
+    buffer_.WriteVLE(STROKE_FILE_VERSION);
+}
+
+unsigned StrokeRecorder::GetTimeMSec()
+{
+    return timer_.GetMSec(false) + timeOffset_;
+}
+
+void StrokeRecorder::BeginStroke(const StrokeBrush &brush, const IntVector2 &pt)
+{
+    // an unterminated stroke is flushed rather than lost
+    if ( recording_ )
+    {
+        EndStroke();
+    }
+
+    strokeBrush_ = brush;
+    strokePoints_.Clear();
+    strokeTimes_.Clear();
+    recording_ = true;
+
+    AddPoint(pt);
+}
+
+void StrokeRecorder::AddPoint(const IntVector2 &pt)
+{
+    if ( !recording_ )
+        return;
+
+    strokePoints_.Push(pt);
+    strokeTimes_.Push(GetTimeMSec());
+}
+
+void StrokeRecorder::EndStroke()
+{
+    if ( !recording_ )
+        return;
+
+    recording_ = false;
+
+    if ( strokePoints_.Size() == 0 )
+        return;
+
+    // the stroke is written as a whole so the point count leads the record
+    // and the reader never has to scan for a terminator
+    unsigned startTime = strokeTimes_[0];
+
+    buffer_.WriteVLE(strokePoints_.Size());
+    buffer_.WriteUInt(strokeBrush_.color_.ToUInt());
+    buffer_.WriteVLE((unsigned)(strokeBrush_.pixelSize_ * BRUSH_SIZE_SCALE + 0.5f));
+    buffer_.WriteVLE(startTime - lastStrokeTime_);
+
+    IntVector2 lastPt(IntVector2::ZERO);
+    unsigned lastTime = startTime;
+
+    for ( unsigned i = 0; i < strokePoints_.Size(); ++i )
+    {
+        IntVector2 delta = strokePoints_[i] - lastPt;
+
+        buffer_.WriteVLE(ZigZagEncode(delta.x_));
+        buffer_.WriteVLE(ZigZagEncode(delta.y_));
+        buffer_.WriteVLE(strokeTimes_[i] - lastTime);
+
+        lastPt = strokePoints_[i];
+        lastTime = strokeTimes_[i];
+    }
+
+    lastStrokeTime_ = startTime;
+    numStrokes_++;
+}
+
+bool StrokeRecorder::Save(Serializer &dest) const
+{
+    return dest.Write(buffer_.GetData(), buffer_.GetSize()) == buffer_.GetSize();
+}
+
+bool StrokeRecorder::Load(Deserializer &source)
+{
+    Clear();
+
+    buffer_.SetData(source, source.GetSize() - source.GetPosition());
+    buffer_.Seek(0);
+
+    // validate and count the strokes, leaving the write position at the end
+    if ( !ReadHeader(buffer_) )
+    {
+        Clear();
+        return false;
+    }
+
+    StrokeBrush brush;
+    PODVector<IntVector2> points;
+    unsigned startDelta = 0;
+
+    while ( !buffer_.IsEof() )
+    {
+        if ( !ReadStroke(buffer_, brush, points, &startDelta) )
+        {
+            Clear();
+            return false;
+        }
+        lastStrokeTime_ += startDelta;
+        numStrokes_++;
+    }
+
+    // strokes recorded after the load continue the loaded timeline
+    timeOffset_ = lastStrokeTime_;
+    timer_.Reset();
+
+    return true;
+}
+
+bool StrokeRecorder::ReadHeader(Deserializer &source)
+{
+    if ( source.ReadFileID() != STROKE_FILE_ID )
+        return false;
+
+    return source.ReadVLE() == STROKE_FILE_VERSION;
+}
+
+bool StrokeRecorder::ReadStroke(Deserializer &source, StrokeBrush &brush, PODVector<IntVector2> &points, unsigned *startDelta)
+{
+    unsigned numPoints = source.ReadVLE();
+
+    if ( numPoints == 0 || source.IsEof() )
+        return false;
+
+    // a point takes at least three bytes, a larger count is a corrupt stream
+    if ( numPoints > (source.GetSize() - source.GetPosition()) / 3 )
+        return false;
+
+    brush.color_ = UIntToColor(source.ReadUInt());
+    brush.pixelSize_ = (float)source.ReadVLE() / BRUSH_SIZE_SCALE;
+
+    // start time: not needed for full speed replay
+    unsigned delta = source.ReadVLE();
+
+    if ( startDelta )
+    {
+        *startDelta = delta;
+    }
+
+    points.Resize(numPoints);
+    IntVector2 pt(IntVector2::ZERO);
+
+    for ( unsigned i = 0; i < numPoints; ++i )
+    {
+        pt.x_ += ZigZagDecode(source.ReadVLE());
+        pt.y_ += ZigZagDecode(source.ReadVLE());
+        source.ReadVLE();
+
+        points[i] = pt;
+    }
+
+    return true;
+}
+
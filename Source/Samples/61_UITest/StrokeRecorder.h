@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Math/Color.h>
+
+using namespace Urho3D;
+//=============================================================================
+// stroke stream layout (all integers are VLE encoded):
+//   header: "STRK", version
+//   stroke: numPoints, brush color (uint), brush size (1/16th pixel),
+//           start time (msec, delta from the previous stroke),
+//           then per point: zigzag dx, zigzag dy, dt (msec)
+// coordinates are element-local, the first point is delta'd from (0,0)
+//=============================================================================
+struct StrokeBrush
+{
+    StrokeBrush() : color_(Color::RED), pixelSize_(1.0f) {}
+    StrokeBrush(const Color &color, float pixelSize) : color_(color), pixelSize_(pixelSize) {}
+
+    Color color_;
+    float pixelSize_;
+};
+
+//=============================================================================
+//=============================================================================
+class StrokeRecorder
+{
+public:
+    StrokeRecorder();
+
+    void Clear();
+    bool IsRecording() const { return recording_; }
+
+    void BeginStroke(const StrokeBrush &brush, const IntVector2 &pt);
+    void AddPoint(const IntVector2 &pt);
+    void EndStroke();
+
+    unsigned GetNumStrokes() const          { return numStrokes_; }
+    const VectorBuffer& GetBuffer() const   { return buffer_; }
+
+    bool Save(Serializer &dest) const;
+    bool Load(Deserializer &source);
+
+    // replay helpers, startDelta receives the stroke's start time relative to the previous one
+    static bool ReadHeader(Deserializer &source);
+    static bool ReadStroke(Deserializer &source, StrokeBrush &brush, PODVector<IntVector2> &points, unsigned *startDelta = NULL);
+
+protected:
+    void WriteHeader();
+    unsigned GetTimeMSec();
+
+protected:
+    VectorBuffer          buffer_;
+    PODVector<IntVector2> strokePoints_;
+    PODVector<unsigned>   strokeTimes_;
+    StrokeBrush           strokeBrush_;
+    unsigned              lastStrokeTime_;
+    unsigned              timeOffset_;
+    unsigned              numStrokes_;
+    bool                  recording_;
+    Timer                 timer_;
+};
+
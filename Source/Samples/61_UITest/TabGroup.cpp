@@ -28,8 +28,10 @@
 #include <Urho3D/UI/Text.h>
 #include <Urho3D/UI/CheckBox.h>
 #include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
 
 #include "TabGroup.h"
+#include "UIStyleSheet.h"
 
 #include <Urho3D/DebugNew.h>
 
@@ -40,7 +42,11 @@ void TabGroup::RegisterObject(Context* context)
     context->RegisterFactory<TabGroup>(UI_CATEGORY);
 }
 
-TabGroup::TabGroup(Context *context) : BorderImage(context)
+TabGroup::TabGroup(Context *context)
+    : BorderImage(context)
+    , selectedIdx_(0)
+    , maxResidentBodies_(0)
+    , visitStamp_(0)
 {
     // default settings
     SetLayoutMode(LM_VERTICAL);
@@ -63,7 +69,11 @@ TabGroup::~TabGroup()
 
 TabElement* TabGroup::CreateTab(const IntVector2 &tabSize, const IntVector2 &bodySize)
 {
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    return CreateTab(tabSize, bodySize, NULL);
+}
+
+TabElement* TabGroup::CreateTab(const IntVector2 &tabSize, const IntVector2 &bodySize, TabBodyBuilder *builder)
+{
     TabElement tabElement;
 
     headerElement_->SetMaxHeight(tabSize.y_);
@@ -71,8 +81,7 @@ TabElement* TabGroup::CreateTab(const IntVector2 &tabSize, const IntVector2 &bod
     // button
     tabElement.tabButton_ = headerElement_->CreateChild<CheckBox>();
 
-    tabElement.tabButton_->SetDefaultStyle(cache->GetResource<XMLFile>("UI/DefaultStyle.xml"));
-    tabElement.tabButton_->SetStyle("TabButton");
+    ApplyStyle(tabElement.tabButton_, "TabButton");
 
     tabElement.tabButton_->SetImageRect(IntRect(208, 64, 224, 80));
     tabElement.tabButton_->SetCheckedOffset(IntVector2(0,16));
@@ -84,16 +93,124 @@ TabElement* TabGroup::CreateTab(const IntVector2 &tabSize, const IntVector2 &bod
     tabElement.tabText_->SetAlignment(HA_CENTER, VA_CENTER);
 
     // body
+    tabElement.bodySize_ = bodySize;
+    tabElement.builder_ = builder;
+    tabElement.lastVisit_ = ++visitStamp_;
+
+    childList_.Push(tabElement);
+
+    // eager tabs and the initially selected one get their body right away
+    if ( builder == NULL || childList_.Size() == 1 )
+    {
+        CreateTabBody(childList_.Size() - 1);
+    }
+
+    return &childList_.Back();
+}
+
+void TabGroup::CreateTabBody(unsigned idx)
+{
+    TabElement &tabElement = childList_[idx];
+
     tabElement.tabBody_ = bodyElement_->CreateChild<BorderImage>();
 
-    tabElement.tabBody_->SetStyle("TabBody");
+    ApplyStyle(tabElement.tabBody_, "TabBody");
     tabElement.tabBody_->SetImageRect(IntRect(192, 80, 208, 96));
-    tabElement.tabBody_->SetSize(bodySize);
-    tabElement.tabBody_->SetVisible(childList_.Size() == 0);
+    tabElement.tabBody_->SetSize(tabElement.bodySize_);
+    tabElement.tabBody_->SetVisible(idx == selectedIdx_);
 
-    childList_.Push(tabElement);
+    if ( tabElement.builder_ )
+    {
+        tabElement.builder_->Invoke(tabElement.tabBody_, idx);
+    }
+}
 
-    return &childList_.Back();
+void TabGroup::ApplyStyle(UIElement *element, const String &styleName)
+{
+    if ( styleSheet_ == NULL )
+    {
+        styleSheet_ = UIStyleSheet::GetStyleSheet(context_, "UI/DefaultStyle.xml");
+    }
+
+    if ( styleSheet_ )
+    {
+        styleSheet_->Apply(element, styleName);
+        return;
+    }
+
+    // the style file didn't compile, the xml path leaves the element unstyled if it's missing
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    element->SetDefaultStyle(cache->GetResource<XMLFile>("UI/DefaultStyle.xml"));
+    element->SetStyle(styleName);
+}
+
+void TabGroup::SetMaxResidentBodies(unsigned maxBodies)
+{
+    maxResidentBodies_ = maxBodies;
+
+    EvictTabBodies();
+}
+
+unsigned TabGroup::GetNumResidentBodies() const
+{
+    unsigned count = 0;
+
+    for ( unsigned i = 0; i < childList_.Size(); ++i )
+    {
+        if ( childList_[i].tabBody_ )
+            count++;
+    }
+
+    return count;
+}
+
+void TabGroup::EvictTabBodies()
+{
+    if ( maxResidentBodies_ == 0 )
+        return;
+
+    // only bodies that can be rebuilt are evictable, oldest visit goes first
+    for ( ;; )
+    {
+        unsigned numResident = 0;
+        unsigned oldestIdx = M_MAX_UNSIGNED;
+
+        for ( unsigned i = 0; i < childList_.Size(); ++i )
+        {
+            const TabElement &tabElement = childList_[i];
+
+            if ( i == selectedIdx_ || !tabElement.tabBody_ || !tabElement.builder_ )
+                continue;
+
+            numResident++;
+
+            if ( oldestIdx == M_MAX_UNSIGNED || tabElement.lastVisit_ < childList_[oldestIdx].lastVisit_ )
+                oldestIdx = i;
+        }
+
+        if ( numResident <= maxResidentBodies_ )
+            break;
+
+        childList_[oldestIdx].tabBody_->Remove();
+        childList_[oldestIdx].tabBody_.Reset();
+    }
+}
+
+bool TabGroup::SetTheme(const String &xmlName)
+{
+    UIStyleSheet *theme = UIStyleSheet::GetStyleSheet(context_, xmlName);
+
+    if ( theme == NULL )
+        return false;
+
+    if ( styleSheet_ && styleSheet_ != theme )
+    {
+        styleSheet_->SwapTheme(this, theme);
+    }
+
+    styleSheet_ = theme;
+
+    return true;
 }
 
 TabElement* TabGroup::GetTabElement(unsigned idx)
@@ -138,11 +255,25 @@ void TabGroup::HandleTabToggled(StringHash eventType, VariantMap& eventData)
             checkedIdx = i;
 
         chkbox->SetCheckedInternal(chkbox == element);
-        childList_[i].tabBody_->SetVisible(chkbox == element);
+
+        if ( childList_[i].tabBody_ )
+        {
+            childList_[i].tabBody_->SetVisible(chkbox == element);
+        }
     }
 
     if (checkedIdx >= 0)
     {
+        selectedIdx_ = (unsigned)checkedIdx;
+        childList_[selectedIdx_].lastVisit_ = ++visitStamp_;
+
+        if ( !childList_[selectedIdx_].tabBody_ )
+        {
+            CreateTabBody(selectedIdx_);
+        }
+
+        EvictTabBodies();
+
         SendTabSelectedEvent(checkedIdx);
     }
 }
@@ -27,6 +27,7 @@ namespace Urho3D
 {
 extern const char* UI_CATEGORY;
 }
+class UIStyleSheet;
 using namespace Urho3D;
 //=============================================================================
 //=============================================================================
@@ -37,11 +38,45 @@ URHO3D_EVENT(E_TABSELECTED, TabSelected)
     URHO3D_PARAM(P_INDEX, Index);                  // int
 }
 
+// fills a freshly created tab body, called the first time the tab is selected
+// and again if the body was evicted in the meantime
+class TabBodyBuilder : public RefCounted
+{
+public:
+    virtual ~TabBodyBuilder() {}
+    virtual void Invoke(BorderImage *tabBody, unsigned idx) = 0;
+};
+
+template <class T> class TabBodyBuilderImpl : public TabBodyBuilder
+{
+public:
+    typedef void (T::*BuilderFunctionPtr)(BorderImage *tabBody, unsigned idx);
+
+    TabBodyBuilderImpl(T *receiver, BuilderFunctionPtr function) : receiver_(receiver), function_(function)
+    {
+        assert(receiver_ && function_);
+    }
+
+    virtual void Invoke(BorderImage *tabBody, unsigned idx) { (receiver_->*function_)(tabBody, idx); }
+
+private:
+    T                  *receiver_;
+    BuilderFunctionPtr  function_;
+};
+
+#define TAB_BODY_BUILDER(className, function) (new TabBodyBuilderImpl<className>(this, &className::function))
+
 struct TabElement
 {
-    WeakPtr<CheckBox>    tabButton_;
-    WeakPtr<Text>        tabText_;
-    WeakPtr<BorderImage> tabBody_;
+    TabElement() : lastVisit_(0) {}
+
+    WeakPtr<CheckBox>      tabButton_;
+    WeakPtr<Text>          tabText_;
+    WeakPtr<BorderImage>   tabBody_;
+
+    IntVector2             bodySize_;
+    SharedPtr<TabBodyBuilder> builder_;
+    unsigned               lastVisit_;
 };
 
 //=============================================================================
@@ -56,16 +91,29 @@ public:
     virtual ~TabGroup();
 
     TabElement* CreateTab(const IntVector2 &tabSize, const IntVector2 &bodySize);
+    // the body is built on first selection, tabBody_ stays null until then, takes ownership of the builder
+    TabElement* CreateTab(const IntVector2 &tabSize, const IntVector2 &bodySize, TabBodyBuilder *builder);
     TabElement* GetTabElement(unsigned idx);
 
+    // xml style name, e.g. "UI/DefaultNoColorStyle.xml", only differing attributes are reapplied
+    bool SetTheme(const String &xmlName);
+
     void SetEnabled(bool enabled);
 
+    // max inactive lazily built bodies kept alive, 0 = no limit
+    void SetMaxResidentBodies(unsigned maxBodies);
+    unsigned GetMaxResidentBodies() const { return maxResidentBodies_; }
+    unsigned GetNumResidentBodies() const;
+
     UIElement* GetHeaderElement() { return headerElement_; }
     UIElement* GetBodyElement()   { return bodyElement_;   }
 
 protected:
     void HandleTabToggled(StringHash eventType, VariantMap& eventData);
     void SendTabSelectedEvent(int idx);
+    void CreateTabBody(unsigned idx);
+    void ApplyStyle(UIElement *element, const String &styleName);
+    void EvictTabBodies();
 
 protected:
     WeakPtr<UIElement> headerElement_;
@@ -73,6 +121,11 @@ protected:
 
     IntVector2         internalSize_; 
     Vector<TabElement> childList_;
+    SharedPtr<UIStyleSheet> styleSheet_;
+
+    unsigned           selectedIdx_;
+    unsigned           maxResidentBodies_;
+    unsigned           visitStamp_;
 };
 
 
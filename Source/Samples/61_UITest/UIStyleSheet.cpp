@@ -0,0 +1,568 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Serializer.h>
+#include <Urho3D/IO/Deserializer.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/UI/UIElement.h>
+
+#include "UIStyleSheet.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+#define STYLE_FILE_ID           "USTL"
+#define STYLE_FILE_VERSION      2
+#define MAX_STYLE_DEPTH         16
+
+// style an element was last given by a sheet, used by theme swaps
+static const StringHash VAR_STYLESHEET_STYLE("StyleSheetStyle");
+
+//=============================================================================
+//=============================================================================
+void UIStyleSheet::RegisterObject(Context* context)
+{
+    context->RegisterFactory<UIStyleSheet>();
+}
+
+UIStyleSheet::UIStyleSheet(Context *context)
+    : Resource(context)
+{
+}
+
+UIStyleSheet::~UIStyleSheet()
+{
+}
+
+UIStyleSheet* UIStyleSheet::GetStyleSheet(Context *context, const String &xmlName)
+{
+    ResourceCache* cache = context->GetSubsystem<ResourceCache>();
+    String sheetName = ReplaceExtension(xmlName, ".ust");
+
+    // precompiled sheet shipped with the data
+    if ( cache->GetExistingResource<UIStyleSheet>(sheetName) || cache->Exists(sheetName) )
+        return cache->GetResource<UIStyleSheet>(sheetName);
+
+    SharedPtr<UIStyleSheet> sheet(new UIStyleSheet(context));
+
+    XMLFile *xmlFile = cache->GetResource<XMLFile>(xmlName);
+
+    if ( !sheet->Compile(xmlFile) )
+        return NULL;
+
+#ifdef _DEBUG
+    sheet->Verify(xmlFile);
+#endif
+
+    sheet->SetName(sheetName);
+    cache->AddManualResource(sheet);
+
+    return sheet;
+}
+
+bool UIStyleSheet::Compile(XMLFile *xmlFile)
+{
+    if ( xmlFile == NULL )
+        return false;
+
+    styles_.Clear();
+    diffCache_.Clear();
+
+    StyleElementMap styleElements;
+    XMLElement root = xmlFile->GetRoot();
+
+    for ( XMLElement elem = root.GetChild("element"); elem; elem = elem.GetNext("element") )
+    {
+        styleElements[elem.GetAttribute("type")] = elem;
+    }
+
+    for ( StyleElementMap::ConstIterator it = styleElements.Begin(); it != styleElements.End(); ++it )
+    {
+        CompiledStyle compiledStyle;
+
+        if ( !CompileStyle(styleElements, it->first_, StringHash::ZERO, compiledStyle, 0) )
+        {
+            URHO3D_LOGWARNINGF("UIStyleSheet: style %s doesn't resolve to an ui type", it->first_.CString());
+            continue;
+        }
+
+        styles_[StringHash(it->first_)] = compiledStyle;
+    }
+
+    return styles_.Size() > 0;
+}
+
+bool UIStyleSheet::CompileStyle(const StyleElementMap &styleElements, const String &styleName, StringHash type, 
+                                CompiledStyle &compiledStyle, unsigned depth) const
+{
+    // inheritance chain, most derived first
+    PODVector<const XMLElement*> chain;
+    String name = styleName;
+    StringHash styleType;
+
+    for ( int level = 0; level < MAX_STYLE_DEPTH; ++level )
+    {
+        StyleElementMap::ConstIterator styleIt = styleElements.Find(name);
+
+        if ( styleType == StringHash::ZERO && context_->GetAttributes(StringHash(name)) )
+            styleType = StringHash(name);
+
+        if ( styleIt == styleElements.End() )
+            break;
+
+        chain.Push(&styleIt->second_);
+
+        String parent = styleIt->second_.GetAttribute("style");
+
+        if ( parent.Empty() || parent == name )
+            break;
+
+        name = parent;
+    }
+
+    // an internal child is styled as the type it actually is
+    if ( type == StringHash::ZERO )
+        type = styleType;
+
+    const Vector<AttributeInfo>* attributes = context_->GetAttributes(type);
+
+    if ( attributes == NULL )
+        return false;
+
+    compiledStyle.type_ = type;
+
+    // base first so that derived styles override, each level's internal
+    // children after its attributes like UIElement::LoadXML
+    for ( int c = (int)chain.Size() - 1; c >= 0; --c )
+    {
+        CompileAttributes(*chain[c], *attributes, compiledStyle);
+        CompileChildren(styleElements, *chain[c], compiledStyle, depth);
+    }
+
+    return true;
+}
+
+void UIStyleSheet::CompileAttributes(const XMLElement &styleElem, const Vector<AttributeInfo> &attributes, CompiledStyle &compiledStyle) const
+{
+    for ( XMLElement attrElem = styleElem.GetChild("attribute"); attrElem; attrElem = attrElem.GetNext("attribute") )
+    {
+        String name = attrElem.GetAttribute("name");
+        unsigned index = M_MAX_UNSIGNED;
+
+        for ( unsigned i = 0; i < attributes.Size(); ++i )
+        {
+            if ( attributes[i].name_ == name )
+            {
+                index = i;
+                break;
+            }
+        }
+
+        if ( index == M_MAX_UNSIGNED )
+            continue;
+
+        const AttributeInfo &attr = attributes[index];
+        Variant value;
+
+        // enums are given by name, same lookup as Serializable::LoadXML
+        if ( attr.enumNames_ )
+        {
+            String valueName = attrElem.GetAttribute("value");
+            const char** enumPtr = attr.enumNames_;
+            int enumValue = 0;
+
+            while ( *enumPtr && valueName.Compare(*enumPtr, false) )
+            {
+                ++enumPtr;
+                ++enumValue;
+            }
+
+            if ( *enumPtr == NULL )
+            {
+                URHO3D_LOGWARNINGF("UIStyleSheet: unknown enum value %s in attribute %s", valueName.CString(), name.CString());
+                continue;
+            }
+
+            value = enumValue;
+        }
+        else
+        {
+            value = attrElem.GetVariantValue(attr.type_);
+        }
+
+        unsigned slot = compiledStyle.attrIndices_.IndexOf(index);
+
+        if ( slot < compiledStyle.attrIndices_.Size() )
+        {
+            compiledStyle.values_[slot] = value;
+        }
+        else
+        {
+            compiledStyle.attrIndices_.Push(index);
+            compiledStyle.attrNames_.Push(name);
+            compiledStyle.values_.Push(value);
+        }
+    }
+}
+
+void UIStyleSheet::CompileChildren(const StyleElementMap &styleElements, const XMLElement &styleElem, CompiledStyle &compiledStyle, unsigned depth) const
+{
+    if ( depth >= MAX_STYLE_DEPTH )
+        return;
+
+    bool firstChild = true;
+
+    for ( XMLElement childElem = styleElem.GetChild("element"); childElem; childElem = childElem.GetNext("element") )
+    {
+        // a style only reaches into existing internal children, popups aren't children
+        if ( !childElem.GetBool("internal") || childElem.GetBool("popup") )
+            continue;
+
+        String typeName = childElem.GetAttribute("type");
+
+        if ( typeName.Empty() )
+            typeName = "UIElement";
+
+        String styleName = childElem.GetAttribute("style");
+
+        if ( styleName.Empty() )
+            styleName = typeName;
+
+        // the child's own style first, then what the parent style sets on top
+        CompiledStyle childStyle;
+
+        if ( !CompileStyle(styleElements, styleName, StringHash(typeName), childStyle, depth + 1) )
+        {
+            URHO3D_LOGWARNINGF("UIStyleSheet: internal child %s doesn't resolve to an ui type", typeName.CString());
+            continue;
+        }
+
+        CompileAttributes(childElem, *context_->GetAttributes(childStyle.type_), childStyle);
+        CompileChildren(styleElements, childElem, childStyle, depth + 1);
+
+        childStyle.matchFromStart_ = firstChild;
+        firstChild = false;
+
+        compiledStyle.children_.Push(childStyle);
+    }
+}
+
+bool UIStyleSheet::BeginLoad(Deserializer& source)
+{
+    styles_.Clear();
+    diffCache_.Clear();
+
+    if ( source.ReadFileID() != STYLE_FILE_ID || source.ReadVLE() != STYLE_FILE_VERSION )
+    {
+        URHO3D_LOGERRORF("UIStyleSheet: %s is not a compiled style sheet", source.GetName().CString());
+        return false;
+    }
+
+    unsigned numStyles = source.ReadVLE();
+
+    for ( unsigned i = 0; i < numStyles; ++i )
+    {
+        CompiledStyle &compiledStyle = styles_[StringHash(source.ReadUInt())];
+
+        if ( !ReadStyle(source, compiledStyle, 0) )
+        {
+            URHO3D_LOGERRORF("UIStyleSheet: %s is corrupt", source.GetName().CString());
+            styles_.Clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool UIStyleSheet::ReadStyle(Deserializer &source, CompiledStyle &compiledStyle, unsigned depth)
+{
+    compiledStyle.type_ = StringHash(source.ReadUInt());
+
+    unsigned numAttributes = source.ReadVLE();
+
+    if ( numAttributes > source.GetSize() - source.GetPosition() )
+        return false;
+
+    compiledStyle.attrIndices_.Resize(numAttributes);
+    compiledStyle.attrNames_.Resize(numAttributes);
+    compiledStyle.values_.Resize(numAttributes);
+
+    for ( unsigned j = 0; j < numAttributes; ++j )
+    {
+        compiledStyle.attrIndices_[j] = source.ReadVLE();
+        compiledStyle.attrNames_[j]   = source.ReadString();
+        compiledStyle.values_[j]      = source.ReadVariant();
+    }
+
+    unsigned numChildren = source.ReadVLE();
+
+    if ( numChildren && (depth >= MAX_STYLE_DEPTH || numChildren > source.GetSize() - source.GetPosition()) )
+        return false;
+
+    compiledStyle.children_.Resize(numChildren);
+
+    for ( unsigned j = 0; j < numChildren; ++j )
+    {
+        compiledStyle.children_[j].matchFromStart_ = source.ReadBool();
+
+        if ( !ReadStyle(source, compiledStyle.children_[j], depth + 1) )
+            return false;
+    }
+
+    return true;
+}
+
+bool UIStyleSheet::Save(Serializer& dest) const
+{
+    dest.WriteFileID(STYLE_FILE_ID);
+    dest.WriteVLE(STYLE_FILE_VERSION);
+    dest.WriteVLE(styles_.Size());
+
+    for ( HashMap<StringHash, CompiledStyle>::ConstIterator it = styles_.Begin(); it != styles_.End(); ++it )
+    {
+        dest.WriteUInt(it->first_.Value());
+        WriteStyle(dest, it->second_);
+    }
+
+    return true;
+}
+
+void UIStyleSheet::WriteStyle(Serializer &dest, const CompiledStyle &compiledStyle) const
+{
+    dest.WriteUInt(compiledStyle.type_.Value());
+    dest.WriteVLE(compiledStyle.attrIndices_.Size());
+
+    for ( unsigned j = 0; j < compiledStyle.attrIndices_.Size(); ++j )
+    {
+        dest.WriteVLE(compiledStyle.attrIndices_[j]);
+        dest.WriteString(compiledStyle.attrNames_[j]);
+        dest.WriteVariant(compiledStyle.values_[j]);
+    }
+
+    dest.WriteVLE(compiledStyle.children_.Size());
+
+    for ( unsigned j = 0; j < compiledStyle.children_.Size(); ++j )
+    {
+        dest.WriteBool(compiledStyle.children_[j].matchFromStart_);
+        WriteStyle(dest, compiledStyle.children_[j]);
+    }
+}
+
+bool UIStyleSheet::Verify(XMLFile *xmlFile)
+{
+    if ( xmlFile == NULL )
+        return false;
+
+    XMLElement root = xmlFile->GetRoot();
+    unsigned numMismatches = 0;
+
+    for ( XMLElement elem = root.GetChild("element"); elem; elem = elem.GetNext("element") )
+    {
+        String styleName = elem.GetAttribute("type");
+        const CompiledStyle *compiledStyle = GetStyle(StringHash(styleName));
+
+        if ( compiledStyle == NULL )
+            continue;
+
+        SharedPtr<UIElement> expected = DynamicCast<UIElement>(context_->CreateObject(compiledStyle->type_));
+        SharedPtr<UIElement> actual = DynamicCast<UIElement>(context_->CreateObject(compiledStyle->type_));
+
+        if ( expected == NULL || actual == NULL )
+            continue;
+
+        expected->SetStyle(styleName, xmlFile);
+        ApplyStyle(actual, *compiledStyle);
+
+        numMismatches += CompareElements(expected, actual, styleName);
+    }
+
+    if ( numMismatches )
+    {
+        URHO3D_LOGWARNINGF("UIStyleSheet: %u attributes differ from %s", numMismatches, xmlFile->GetName().CString());
+    }
+
+    return numMismatches == 0;
+}
+
+unsigned UIStyleSheet::CompareElements(UIElement *expected, UIElement *actual, const String &path) const
+{
+    const Vector<AttributeInfo>* attributes = expected->GetAttributes();
+    unsigned numMismatches = 0;
+
+    for ( unsigned i = 0; attributes && i < attributes->Size(); ++i )
+    {
+        // the applied style name is bookkeeping, not styling
+        if ( attributes->At(i).name_ == "Style" )
+            continue;
+
+        if ( expected->GetAttribute(i) != actual->GetAttribute(i) )
+        {
+            URHO3D_LOGWARNINGF("UIStyleSheet: %s %s is %s, xml style gives %s", path.CString(), attributes->At(i).name_.CString(),
+                               actual->GetAttribute(i).ToString().CString(), expected->GetAttribute(i).ToString().CString());
+            numMismatches++;
+        }
+    }
+
+    for ( unsigned i = 0; i < expected->GetNumChildren() && i < actual->GetNumChildren(); ++i )
+    {
+        numMismatches += CompareElements(expected->GetChild(i), actual->GetChild(i), path + "/" + expected->GetChild(i)->GetTypeName());
+    }
+
+    return numMismatches;
+}
+
+const CompiledStyle* UIStyleSheet::GetStyle(StringHash style) const
+{
+    HashMap<StringHash, CompiledStyle>::ConstIterator it = styles_.Find(style);
+
+    return it != styles_.End() ? &it->second_ : NULL;
+}
+
+bool UIStyleSheet::Apply(UIElement *element, StringHash style) const
+{
+    const CompiledStyle *compiledStyle = GetStyle(style);
+
+    if ( element == NULL || compiledStyle == NULL )
+        return false;
+
+    element->SetVar(VAR_STYLESHEET_STYLE, style);
+
+    return ApplyStyle(element, *compiledStyle);
+}
+
+bool UIStyleSheet::ApplyStyle(UIElement *element, const CompiledStyle &compiledStyle) const
+{
+    const Vector<AttributeInfo>* attributes = element->GetAttributes();
+
+    if ( attributes == NULL )
+        return false;
+
+    // same type: indices are used as they are. derived types copy the base
+    // attributes first so the indices normally still line up, the name check
+    // catches the ones that don't
+    bool sameType = element->GetType() == compiledStyle.type_;
+
+    for ( unsigned i = 0; i < compiledStyle.attrIndices_.Size(); ++i )
+    {
+        unsigned index = compiledStyle.attrIndices_[i];
+
+        if ( !sameType && (index >= attributes->Size() || attributes->At(index).name_ != compiledStyle.attrNames_[i]) )
+        {
+            element->SetAttribute(compiledStyle.attrNames_[i], compiledStyle.values_[i]);
+            continue;
+        }
+
+        element->SetAttribute(index, compiledStyle.values_[i]);
+    }
+
+    unsigned nextInternalChild = 0;
+
+    for ( unsigned i = 0; i < compiledStyle.children_.Size(); ++i )
+    {
+        const CompiledStyle &childStyle = compiledStyle.children_[i];
+
+        if ( childStyle.matchFromStart_ )
+            nextInternalChild = 0;
+
+        for ( unsigned j = nextInternalChild; j < element->GetNumChildren(); ++j )
+        {
+            UIElement *child = element->GetChild(j);
+
+            if ( child->IsInternal() && child->GetType() == childStyle.type_ )
+            {
+                ApplyStyle(child, childStyle);
+                nextInternalChild = j + 1;
+                break;
+            }
+        }
+    }
+
+    element->ApplyAttributes();
+
+    return true;
+}
+
+void UIStyleSheet::SwapTheme(UIElement *root, UIStyleSheet *theme)
+{
+    if ( root == NULL || theme == NULL )
+        return;
+
+    PODVector<UIElement*> elements;
+    root->GetChildren(elements, true);
+    elements.Push(root);
+
+    for ( unsigned i = 0; i < elements.Size(); ++i )
+    {
+        const Variant &var = elements[i]->GetVar(VAR_STYLESHEET_STYLE);
+
+        if ( var.IsEmpty() )
+            continue;
+
+        const CompiledStyle *diff = GetThemeDiff(var.GetStringHash(), theme);
+
+        if ( diff && (diff->attrIndices_.Size() || diff->children_.Size()) )
+        {
+            ApplyStyle(elements[i], *diff);
+        }
+    }
+}
+
+const CompiledStyle* UIStyleSheet::GetThemeDiff(StringHash style, UIStyleSheet *theme)
+{
+    StringHash key(style.Value() ^ theme->GetNameHash().Value());
+    HashMap<StringHash, CompiledStyle>::ConstIterator it = diffCache_.Find(key);
+
+    if ( it != diffCache_.End() )
+        return &it->second_;
+
+    const CompiledStyle *from = GetStyle(style);
+    const CompiledStyle *to = theme->GetStyle(style);
+
+    if ( to == NULL )
+        return NULL;
+
+    // only what the theme sets differently
+    CompiledStyle &diff = diffCache_[key];
+    diff.type_ = to->type_;
+
+    for ( unsigned i = 0; i < to->attrIndices_.Size(); ++i )
+    {
+        unsigned slot = from ? from->attrIndices_.IndexOf(to->attrIndices_[i]) : M_MAX_UNSIGNED;
+
+        if ( from && slot < from->attrIndices_.Size() && from->values_[slot] == to->values_[i] )
+            continue;
+
+        diff.attrIndices_.Push(to->attrIndices_[i]);
+        diff.attrNames_.Push(to->attrNames_[i]);
+        diff.values_.Push(to->values_[i]);
+    }
+
+    // internal children are reapplied whole
+    diff.children_ = to->children_;
+
+    return &diff;
+}
+
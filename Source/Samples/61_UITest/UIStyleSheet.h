@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+#include <Urho3D/Resource/Resource.h>
+
+namespace Urho3D
+{
+class UIElement;
+class XMLElement;
+class XMLFile;
+}
+
+using namespace Urho3D;
+//=============================================================================
+// resolved attribute set of one style, inheritance already flattened
+//=============================================================================
+struct CompiledStyle
+{
+    CompiledStyle() : matchFromStart_(false) {}
+
+    StringHash            type_;
+    PODVector<unsigned>   attrIndices_;
+    Vector<String>        attrNames_;
+    Vector<Variant>       values_;
+
+    // internal children in application order, matched to the element's internal
+    // children by type the way UIElement::LoadXML does. every style level starts
+    // matching from the first internal child again
+    Vector<CompiledStyle> children_;
+    bool                  matchFromStart_;
+};
+
+//=============================================================================
+// xml ui style compiled into a flat table keyed by style name hash.
+// binary layout: "USTL", version, numStyles (VLE), per style: name hash, style
+//   style: type hash, numAttributes (VLE), per attribute: index (VLE), name, value,
+//          numChildren (VLE), per child: matchFromStart, style
+//=============================================================================
+class UIStyleSheet : public Resource
+{
+    URHO3D_OBJECT(UIStyleSheet, Resource);
+public:
+    static void RegisterObject(Context* context);
+
+    UIStyleSheet(Context *context);
+    virtual ~UIStyleSheet();
+
+    // compiled sheet for an xml style, loaded from the .ust next to it or compiled and cached
+    static UIStyleSheet* GetStyleSheet(Context *context, const String &xmlName);
+
+    bool Compile(XMLFile *xmlFile);
+    // styles a fresh element of every type both ways and logs where the result differs from SetStyle
+    bool Verify(XMLFile *xmlFile);
+    virtual bool BeginLoad(Deserializer& source);
+    virtual bool Save(Serializer& dest) const;
+
+    bool Apply(UIElement *element, StringHash style) const;
+    void SwapTheme(UIElement *root, UIStyleSheet *theme);
+
+    const CompiledStyle* GetStyle(StringHash style) const;
+    unsigned GetNumStyles() const { return styles_.Size(); }
+
+protected:
+    typedef HashMap<String, XMLElement> StyleElementMap;
+
+    bool CompileStyle(const StyleElementMap &styleElements, const String &styleName, StringHash type, CompiledStyle &compiledStyle, unsigned depth) const;
+    void CompileAttributes(const XMLElement &styleElem, const Vector<AttributeInfo> &attributes, CompiledStyle &compiledStyle) const;
+    void CompileChildren(const StyleElementMap &styleElements, const XMLElement &styleElem, CompiledStyle &compiledStyle, unsigned depth) const;
+    void WriteStyle(Serializer &dest, const CompiledStyle &compiledStyle) const;
+    bool ReadStyle(Deserializer &source, CompiledStyle &compiledStyle, unsigned depth);
+    bool ApplyStyle(UIElement *element, const CompiledStyle &compiledStyle) const;
+    unsigned CompareElements(UIElement *expected, UIElement *actual, const String &path) const;
+    const CompiledStyle* GetThemeDiff(StringHash style, UIStyleSheet *theme);
+
+protected:
+    HashMap<StringHash, CompiledStyle> styles_;
+    HashMap<StringHash, CompiledStyle> diffCache_;
+};
+